@@ -26,6 +26,26 @@ Circuit::Circuit(char* file) {
     cktNode *currNode;
     string currLine;
     lineNum = 0;
+    this->maxLevel = 0;
+    this->netlist = NULL;
+    this->tape = NULL;
+    this->nativeSim = NULL;
+    this->faultSim = NULL;
+    this->compactor = NULL;
+    this->scoap = NULL;
+    this->cop = NULL;
+    this->implications = NULL;
+    this->satAtpg = NULL;
+    this->activation = {NULL, X};
+    this->backtrackLimit = MAXBACKTRACK;
+    this->searchLimit = MAXBACKTRACK;
+    this->timeLimit = MAXFAULTTIME;
+    clearStats(this->stats);
+    this->ordered = false;
+    this->dominators = NULL;
+    this->useFan = false;
+    this->syncMark = 0;
+    this->parent = NULL;
     if (cktFile.good()) {
         while (getline(cktFile, currLine)) {
             istringstream ss(currLine);
@@ -72,6 +92,7 @@ Circuit::Circuit(char* file) {
         linkNodes();
         verifyLink(); //assert
         levelize();
+        buildNetlist();
     }
 
     char* fileName = strdup(file);
@@ -85,11 +106,85 @@ Circuit::Circuit(char* file) {
     
     this->cktName = fileName;
     this->numNodes = lineNum ;
-    this->maxLevel = 0;
     this->initialized = false;
+    this->allX = true;
     assert(this->numNodes == this->nodes.size());
 }
 
+// ATPG worker: a copy of parent's nodes, so it has node values of its
+// own, with its own search and simulation buffers. The netlist, the
+// testability measures, the dominators and the learned implications are
+// parent's and are not rebuilt.
+Circuit::Circuit(Circuit* parent) {
+    this->parent = parent;
+    this->cktName = parent->cktName;
+    this->maxLevel = parent->maxLevel;
+    this->numNodes = parent->numNodes;
+    this->numGates = parent->numGates;
+    for (cktMap::iterator it = parent->nodes.begin(); it != parent->nodes.end(); ++it) {
+        cktNode* orig = it->second;
+        cktNode* currNode = new cktNode(orig->getNodeID(), orig->getLineNum(), orig->getGateType(),
+                orig->getNodeType(), orig->getNumFanIns(), orig->getNumFanOuts(), orig->getUpstreamIDs());
+        currNode->setLevel(orig->getLevel());
+        currNode->setIndex(orig->getIndex());
+        nodes[it->first] = currNode;
+        levNodes[orig->getLevel()].push_back(currNode);
+    }
+    for (int i = 0; i < parent->PInodes.size(); i++) {
+        PInodes.push_back(nodes[parent->PInodes[i]->getNodeID()]);
+    }
+    for (int i = 0; i < parent->POnodes.size(); i++) {
+        POnodes.push_back(nodes[parent->POnodes[i]->getNodeID()]);
+    }
+    for (int i = 0; i < parent->FBnodes.size(); i++) {
+        FBnodes.push_back(nodes[parent->FBnodes[i]->getNodeID()]);
+    }
+    linkNodes();
+
+    this->netlist = parent->netlist;
+    this->scoap = parent->scoap;
+    this->cop = parent->cop;
+    this->dominators = parent->dominators;
+    this->implications = parent->implications;
+    this->headline = parent->headline;
+    initSearch();
+
+    this->tape = NULL;
+    this->nativeSim = NULL;
+    this->faultSim = NULL;
+    this->compactor = NULL;
+    this->satAtpg = NULL;
+    this->activation = {NULL, X};
+    this->backtrackLimit = parent->backtrackLimit;
+    this->searchLimit = parent->searchLimit;
+    this->timeLimit = parent->timeLimit;
+    clearStats(this->stats);
+    this->ordered = parent->ordered;
+    this->useFan = parent->useFan;
+    this->syncMark = 0;
+    this->initialized = false;
+    this->allX = true;
+}
+
+// A worker leaves what it shares with its parent to the parent
+Circuit::~Circuit() {
+    for (cktMap::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        delete it->second;
+    }
+    delete tape;
+    delete nativeSim;
+    delete faultSim;
+    delete compactor;
+    delete satAtpg;
+    if (parent == NULL) {
+        delete netlist;
+        delete scoap;
+        delete cop;
+        delete implications;
+        delete dominators;
+    }
+}
+
 void Circuit::resetPO() {
     for (int i = 0; i < POnodes.size(); i++) {
         POnodes[i]->resetValue();
@@ -139,6 +234,14 @@ vector<int> Circuit::getNodeIDs(){
     return nodeIDs;
 }
 
+vector<int> Circuit::getPIs() {
+    vector<int> piIDs;
+    for (int i = 0; i < PInodes.size(); i++) {
+        piIDs.push_back(PInodes[i]->getNodeID());
+    }
+    return piIDs;
+}
+
 
 void Circuit::levelize() {
     for (int i = 0; i < PInodes.size(); i++) {
@@ -154,6 +257,62 @@ void Circuit::levelize() {
 }
 
 
+void Circuit::buildNetlist() {
+    netlist = new Netlist(&nodes, &PInodes, &POnodes);
+    scoap = new Scoap(netlist);
+    cop = new Cop(netlist);
+    dominators = new Dominators(netlist);
+    findHeadlines();
+    initSearch();
+}
+
+// Sizes the event queue and the search buffers to the netlist
+void Circuit::initSearch() {
+    int n = netlist->getNumNodes();
+    indexNodes.assign(n, NULL);
+    for (cktMap::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        indexNodes[it->second->getIndex()] = it->second;
+    }
+    eventQueue.assign(netlist->getMaxLevel() + 1, vector<int>());
+    queued.assign(n, 0);
+    minQueuedLevel = netlist->getMaxLevel() + 1;
+    necessaryMark.assign(2 * n, 0);
+
+    xBlocked.assign(n, 0);
+    frontierPos.assign(n, -1);
+    frontierJoined.assign(n, 0);
+    frontierClock = 0;
+}
+
+// A node is bound when a fanout stem lies in its transitive fanin, and
+// free otherwise, so the fanin cone of a free node is a tree. Free nodes
+// feeding a bound node, and free POs, are the headlines: FAN can assign
+// them like PIs and justify them after the search.
+void Circuit::findHeadlines() {
+    int n = netlist->getNumNodes();
+    vector<char> bound(n, 0);
+    for (int idx = 0; idx < n; idx++) {
+        const int* in = netlist->getFanIns(idx);
+        bound[idx] = netlist->getNodeType(idx) == FB;
+        for (int j = 0; j < netlist->getNumFanIns(idx) && !bound[idx]; j++) {
+            bound[idx] = bound[in[j]] || netlist->getNumFanOuts(in[j]) > 1;
+        }
+    }
+
+    headline.assign(n, 0);
+    for (int idx = 0; idx < n; idx++) {
+        if (bound[idx]) {
+            continue;
+        }
+        const int* out = netlist->getFanOuts(idx);
+        headline[idx] = netlist->getNodeType(idx) == PO;
+        for (int j = 0; j < netlist->getNumFanOuts(idx) && !headline[idx]; j++) {
+            headline[idx] = bound[out[j]];
+        }
+    }
+}
+
+
 void Circuit::levelize(cktNode* currNode, int currLevel) {
     int nodeLevel = currNode->getLevel();
     if (nodeLevel != -1) {
@@ -167,65 +326,95 @@ void Circuit::levelize(cktNode* currNode, int currLevel) {
         maxLevel = currLevel;
     }
 
+    const cktList& dsl = currNode->getDownstreamList();
     for(int i = 0; i < currNode->getNumFanOuts(); i++) {
-        cktList dsl = currNode->getDownstreamList();
         levelize(dsl[i], currLevel + 1);
     }
 }
 
 
 void Circuit::simulate(inputMap* inputmap) {
-    cktQ toEvaluate;
-    cktQ notEvaluated;
-    inputMap input = *inputmap;
-
-    for (inputMap::iterator it = input.begin(); it != input.end(); ++it) {
-        int nodeID = it->first;
+    for (inputMap::iterator it = inputmap->begin(); it != inputmap->end(); ++it) {
+        cktNode* inNode = nodes[it->first];
         LOGIC inValue = it->second;
-        if (!initialized || inValue != nodes[nodeID]->getValue()) {
-            nodes[nodeID]->setValue(inValue);
-            for (int j = 0; j < nodes[nodeID]->getDownstreamList().size(); j++){
-                toEvaluate.push(nodes[nodeID]->getDownstreamList()[j]);
-            }
+        if (!initialized || inValue != inNode->getValue()) {
+            inNode->setValue(inValue);
+            scheduleFanouts(inNode);
         }
     }
 
-    cktList xList;
-    simulate(&toEvaluate, &notEvaluated, 1, &xList);
+    propagate();
     initialized = true;
+    allX = false;
+    trail.clear();
 }
 
 
-void Circuit::simulate(cktQ *toEvaluate, cktQ *notEvaluated, int level, cktList* dFrontier) {
-    if (toEvaluate->size() == 0) {
-        return;
+// Good-machine simulation over the compiled tape. Every gate is evaluated
+// once per call; results are read back with getCompiledValue().
+void Circuit::simulateCompiled(inputMap* input) {
+    if (tape == NULL) {
+        tape = new SimTape(netlist);
     }
-    
-    while(toEvaluate->size()) {
-        cktNode *currNode = toEvaluate->front();
-        toEvaluate->pop();
-
-        if (currNode->getLevel() != level) {
-            notEvaluated->push(currNode);
-        } else if (currNode->evaluate()) {
-            for (int i = 0; i < currNode->getDownstreamList().size(); i++) {
-                notEvaluated->push(currNode->getDownstreamList()[i]);
-            }
-        } else if (currNode->getValue() == X){
-            bool dFront = false;
-            for (int i = 0; i < currNode->getUpstreamList().size(); i++) {
-                if (currNode->getUpstreamList()[i]->getValue() == D
-                    || currNode->getUpstreamList()[i]->getValue() == DB) {
-                        dFront = true;
-                }
-            }
-            if (dFront) {
-                dFrontier->push_back(currNode);
+    for (inputMap::iterator it = input->begin(); it != input->end(); ++it) {
+        tape->setValue(netlist->getIndex(it->first), it->second);
+    }
+    tape->run();
+}
+
+
+LOGIC Circuit::getCompiledValue(int nodeID) {
+    return tape->getValue(netlist->getIndex(nodeID));
+}
+
+
+// 64-pattern simulator backed by generated code; falls back to the
+// word-level interpreter when the kernel cannot be built.
+CompiledSim* Circuit::getNativeSim() {
+    if (nativeSim == NULL) {
+        nativeSim = new CompiledSim(netlist, cktName);
+        nativeSim->load();
+    }
+    return nativeSim;
+}
+
+
+void Circuit::scheduleFanouts(cktNode* node) {
+    int idx = node->getIndex();
+    const int* fanouts = netlist->getFanOuts(idx);
+    for (int i = 0; i < netlist->getNumFanOuts(idx); i++) {
+        int fo = fanouts[i];
+        if (!queued[fo]) {
+            int level = netlist->getLevel(fo);
+            queued[fo] = 1;
+            eventQueue[level].push_back(fo);
+            if (level < minQueuedLevel) {
+                minQueuedLevel = level;
             }
         }
     }
+}
 
-    simulate(notEvaluated, toEvaluate, level + 1, dFrontier);
+
+// Evaluates every scheduled node in level order. Every value change is
+// recorded on the trail so it can be undone.
+void Circuit::propagate() {
+    for (int level = minQueuedLevel; level < eventQueue.size(); level++) {
+        vector<int>& bucket = eventQueue[level];
+        for (int i = 0; i < bucket.size(); i++) {
+            int idx = bucket[i];
+            cktNode* currNode = indexNodes[idx];
+            queued[idx] = 0;
+
+            LOGIC prev = currNode->getTrueValue();
+            if (currNode->evaluate()) {
+                trail.push_back(make_pair(currNode, prev));
+                scheduleFanouts(currNode);
+            }
+        }
+        bucket.clear();
+    }
+    minQueuedLevel = eventQueue.size();
 }
 
 
@@ -235,11 +424,103 @@ LOGIC Circuit::getNodeLogic(int nodeID) {
 
 
 void Circuit::reset() {
-    for (cktMap::iterator it = nodes.begin(); it != nodes.end(); ++it) {
-        cktNode *currNode = it->second;
-        currNode->reset();
+    for (int i = 0; i < indexNodes.size(); i++) {
+        indexNodes[i]->reset();
     }
     initialized = false;
+    allX = true;
+    trail.clear();
+}
+
+
+// Sets node to v and propagates the change, recording it on the trail
+void Circuit::assign(cktNode* node, LOGIC v) {
+    trail.push_back(make_pair(node, node->getTrueValue()));
+    node->setValue(v);
+    scheduleFanouts(node);
+    propagate();
+}
+
+
+// Restores the values changed since the trail was mark entries long,
+// and the D-frontier and blocked marks derived from them
+void Circuit::undoTrail(int mark) {
+    while (trail.size() > mark) {
+        trail.back().first->setValue(trail.back().second);
+        trail.pop_back();
+    }
+    while (!searchLog.empty() && searchLog.back().trailMark >= mark) {
+        int idx = searchLog.back().idx;
+        switch (searchLog.back().op) {
+            case XPATH_BLOCKED:
+                xBlocked[idx] = 0;
+                break;
+            case FRONTIER_ADDED:
+                frontierPos[dFrontier.back()] = frontierPos[idx];
+                dFrontier[frontierPos[idx]] = dFrontier.back();
+                dFrontier.pop_back();
+                frontierPos[idx] = -1;
+                break;
+            case FRONTIER_REMOVED:
+                frontierPos[idx] = dFrontier.size();
+                dFrontier.push_back(idx);
+                break;
+        }
+        searchLog.pop_back();
+    }
+    syncMark = min(syncMark, mark);
+}
+
+
+// Folds the trail entries made since the last call into the D-frontier.
+// Only the changed nodes and their fanouts can enter or leave it.
+// Changes are logged against syncMark, the trail length the search
+// decides from, for undoTrail.
+void Circuit::syncSearch() {
+    for (int t = syncMark; t < trail.size(); t++) {
+        cktNode* node = trail[t].first;
+        int idx = node->getIndex();
+        LOGIC v = node->getValue();
+        if (v == X || frontierPos[idx] >= 0) {
+            updateFrontier(idx);
+        }
+        // fanouts only care whether this input carries the fault effect
+        LOGIC old = trail[t].second;
+        if (v == D || v == DB || old == D || old == DB || node->isStuckAt()) {
+            const int* out = netlist->getFanOuts(idx);
+            for (int j = 0; j < netlist->getNumFanOuts(idx); j++) {
+                updateFrontier(out[j]);
+            }
+        }
+    }
+    syncMark = trail.size();
+}
+
+// Adds idx to the D-frontier or drops it, whichever its values call for
+void Circuit::updateFrontier(int idx) {
+    bool member = false;
+    if (indexNodes[idx]->getValue() == X) {
+        const int* in = netlist->getFanIns(idx);
+        for (int j = 0; j < netlist->getNumFanIns(idx) && !member; j++) {
+            LOGIC v = indexNodes[in[j]]->getValue();
+            member = v == D || v == DB;
+        }
+    }
+    if (member == (frontierPos[idx] >= 0)) {
+        return;
+    }
+    if (member) {
+        frontierPos[idx] = dFrontier.size();
+        frontierJoined[idx] = frontierClock++;
+        dFrontier.push_back(idx);
+        searchLog.push_back({syncMark, idx, FRONTIER_ADDED});
+    } else {
+        frontierPos[dFrontier.back()] = frontierPos[idx];
+        dFrontier[frontierPos[idx]] = dFrontier.back();
+        dFrontier.pop_back();
+        frontierPos[idx] = -1;
+        searchLog.push_back({syncMark, idx, FRONTIER_REMOVED});
+    }
 }
 
 
@@ -314,12 +595,10 @@ double Circuit::faultCoverage(faultSet* detectedFaults) {
 
 inputMap* Circuit::randomTestGen() {
     int numPIs = PInodes.size();
-    ulong randomBits = rand() % (int(pow(2, numPIs)));
     inputMap* test = new inputMap();
 
     for (int i = 0; i < numPIs; i++) {
-        (*test)[PInodes[i]->getNodeID()] = (LOGIC)(randomBits & 0b001);
-        randomBits = randomBits >> 1;
+        (*test)[PInodes[i]->getNodeID()] = (LOGIC)(rand() & 1);
     }
 
     return test;
@@ -335,24 +614,92 @@ inputList Circuit::randomTestsGen(int numTest) {
 }
 
 
+// Random tests with PI weights fitted by COP so that numTest of them are
+// expected to detect the most collapsed faults. Every other block of 64
+// is uniform, which bounds the loss where COP's independence assumption
+// misjudges reconvergent logic.
+inputList Circuit::weightedTestsGen(int numTest) {
+    faultSet faults = generateFaults(true);
+    vector<pair<int, int> > fl;
+    for (faultSet::iterator it = faults.begin(); it != faults.end(); ++it) {
+        fl.push_back(make_pair((*it)->getNode()->getIndex(), (*it)->getSAV()));
+        delete *it;
+    }
+    cop->optimize(fl, numTest);
+
+    uint64_t seed = RANDOMSEED ^ ((uint64_t) rand() << 32) ^ rand();
+    vector<uint64_t> words(PInodes.size());
+    inputList tests;
+    for (int t = 0; t < numTest; t++) {
+        if (t % 64 == 0) {
+            bool uniform = (t / 64) % 2 == 1;
+            for (int i = 0; i < PInodes.size(); i++) {
+                words[i] = uniform ? randomWord(seed) : weightedWord(seed, cop->getWeight(PInodes[i]->getIndex()));
+            }
+        }
+        inputMap* test = new inputMap();
+        for (int i = 0; i < PInodes.size(); i++) {
+            (*test)[PInodes[i]->getNodeID()] = ((words[i] >> (t % 64)) & 1) ? ONE : ZERO;
+        }
+        tests.push_back(test);
+    }
+    return tests;
+}
+
+
+// Pattern-parallel single fault propagation: PPSFP_WIDTH inputs are
+// simulated at once and every remaining fault is propagated through its
+// fanout cone only. A fault is reported under the first input that
+// detects it and is then dropped from fl.
 faultMap* Circuit::deductiveFaultSim(faultSet* fl, inputList* ins) {
+    return blockFaultSim(fl, ins, false);
+}
+
+
+// Same contract as deductiveFaultSim, but each block of inputs is graded
+// by one critical path tracing pass instead of one propagation per fault.
+faultMap* Circuit::criticalPathFaultSim(faultSet* fl, inputList* ins) {
+    return blockFaultSim(fl, ins, true);
+}
+
+
+faultMap* Circuit::blockFaultSim(faultSet* fl, inputList* ins, bool traced) {
     faultMap* detectedFaults = new faultMap();
-    bool faultDetected;
+
+    if (faultSim == NULL) {
+        faultSim = new FaultSim(netlist, cktName);
+    }
 
     Fault* currFault;
     inputMap* currInput;
+    vector<inputMap*> block;
+    vector<char> live;              // nodes with a fault still in fl
+
+    inputList::iterator it = ins->begin();
+    while (it != ins->end() && !fl->empty()) {
+        block.clear();
+        faultSim->clearPatterns();
+        for (; it != ins->end() && block.size() < PPSFP_WIDTH; ++it) {
+            faultSim->setPattern(block.size(), *it);
+            block.push_back(*it);
+        }
+        faultSim->simulateGood();
+        if (traced) {
+            live.assign(netlist->getNumNodes(), 0);
+            for (faultSet::iterator itt = fl->begin(); itt != fl->end(); ++itt) {
+                live[(*itt)->getNode()->getIndex()] = 1;
+            }
+            faultSim->tracePaths(live);
+        }
 
-    for (inputList::iterator it = ins->begin(); it != ins->end(); ++it) {
         for (faultSet::iterator itt = fl->begin(); itt != fl->end();) {
-            this->reset();
             currFault = *itt;
-            this->addFault(currFault);
-            currInput = *it;
-            this->simulate(currInput);
+            int idx = currFault->getNode()->getIndex();
+            uint64_t detected = traced ? faultSim->detectTraced(idx, currFault->getSAV())
+                                       : faultSim->detect(idx, currFault->getSAV());
 
-            //cout << currFault << " " << currInput << "\n";
-
-            if(faultAtPO()) {
+            if (detected) {
+                currInput = block[__builtin_ctzll(detected)];
                 if (!detectedFaults->count(currInput)) {
                     detectedFaults->insert(pair<inputMap*,faultList*>(currInput, new faultList()));
                 }
@@ -368,40 +715,134 @@ faultMap* Circuit::deductiveFaultSim(faultSet* fl, inputList* ins) {
 }
 
 
-void Circuit::backwardsImplication(cktNode* root) {
+bool Circuit::backwardsImplication(cktNode* root) {
+    if (!learnedImplication(root, root->getTrueValue())) {
+        return false;
+    }
+
+    // imply() may set any fanin; trail them all so the values can be undone
+    const cktList& usl = root->getUpstreamList();
+    for (int i = 0; i < usl.size(); i++) {
+        trail.push_back(make_pair(usl[i], usl[i]->getTrueValue()));
+    }
     if(!root->imply()) {
-        cktQ toEvaluate;
-        cktQ notEvaluated;
-        cktList dFrontier;
-        for (int i = 0; i < root->getDownstreamList().size(); i ++) {
-            toEvaluate.push(root->getDownstreamList()[i]);
+        scheduleFanouts(root);
+        propagate();
+        return true;
+    }
+
+    for (int i = 0; i < usl.size(); i++) {
+        if (!backwardsImplication(usl[i])) {
+            return false;
         }
-        this->simulate(&toEvaluate, &notEvaluated, root->getLevel() + 1, &dFrontier);
-        return;
+    }
+    return true;
+}
+
+
+// Adds the assignments the learned table implies from root = v to the
+// necessary list, following implied literals transitively. Learned
+// nodes sit at a lower level than root, so they are never in the fanout
+// cone of the fault being justified. False if one of them already holds
+// the other value.
+bool Circuit::learnedImplication(cktNode* root, LOGIC v) {
+    if (implications == NULL || (v != ZERO && v != ONE)) {
+        return true;
     }
 
-    for (int i = 0; i < root->getUpstreamList().size(); i++) {
-        backwardsImplication(root->getUpstreamList()[i]);
+    vector<int> stack(1, 2 * root->getIndex() + v);
+    while (!stack.empty()) {
+        int lit = stack.back();
+        stack.pop_back();
+        int idx = Implications::litNode(lit);
+        const int* implied = implications->getImplied(idx, Implications::litValue(lit));
+        for (int i = 0; i < implications->getNumImplied(idx, Implications::litValue(lit)); i++) {
+            cktNode* node = indexNodes[Implications::litNode(implied[i])];
+            LOGIC w = (LOGIC)Implications::litValue(implied[i]);
+            if (node->getTrueValue() != X && node->getTrueValue() != w) {
+                return false;
+            }
+            if (!necessaryMark[implied[i]]) {
+                necessaryMark[implied[i]] = 1;
+                necessary.push_back(make_pair(node, w));
+                stack.push_back(implied[i]);
+            }
+        }
     }
+    return true;
+}
+
+
+// True unless a branch fault's stem is still X; a value other than the
+// one activation needs has already removed the fault effect
+bool Circuit::activated() {
+    return activation.node == NULL || activation.node->getTrueValue() != X;
 }
 
+// False if a node on the necessary list holds the opposite value
+bool Circuit::necessaryHolds() {
+    for (int i = 0; i < necessary.size(); i++) {
+        LOGIC curr = necessary[i].first->getTrueValue();
+        if (curr != X && curr != necessary[i].second) {
+            return false;
+        }
+    }
+    return true;
+}
 
-OBJECTIVE Circuit::objective(cktList* dFrontier) {
-    OBJECTIVE obj;
 
-    if (dFrontier->empty()) {
-        return {NULL, X};
+// The most observable D-frontier gate with an X input left, or NULL;
+// *count returns the number of such gates
+cktNode* Circuit::dFrontierGate(int* count) {
+    cktNode* dGate = NULL;
+    *count = 0;
+    for (int i = 0; i < dFrontier.size(); i++) {
+        cktNode* gate = indexNodes[dFrontier[i]];
+        if (gate->getUnassignedInput(false) == NULL) {
+            continue;
+        }
+        (*count)++;
+        int co = scoap->getCO(gate->getIndex());
+        if (dGate == NULL || co < scoap->getCO(dGate->getIndex()) || (co == scoap->getCO(dGate->getIndex()) &&
+                frontierJoined[gate->getIndex()] < frontierJoined[dGate->getIndex()])) {
+            dGate = gate;
+        }
+    }
+    return dGate;
+}
+
+// The objective is a non-controlling value on the most controllable X
+// input of the most observable D-frontier gate. When that gate is the
+// only one, the side inputs of its dominators come first, hardest
+// first; {NULL, X} if one of them is already controlling. Activating a
+// branch fault comes before all of these.
+OBJECTIVE Circuit::objective() {
+    if (!activated()) {
+        return activation;
     }
 
-    cktNode* dGate;
-    cktNode* dIn;
+    int dGates;
+    cktNode* dGate = dFrontierGate(&dGates);
+    if (dGate == NULL) {
+        return {NULL, X};
+    }
 
-    do {
-        dGate = dFrontier->back();
-        dFrontier->pop_back();
-        dIn = dGate->getUnassignedInput(true);
-    } while (dIn == NULL && !dFrontier->empty());
-    dFrontier->push_back(dGate);
+    if (dGates == 1) {
+        vector<OBJECTIVE> open;
+        if (!dominatorSideInputs(dGate, &open)) {
+            return {NULL, X};
+        }
+        OBJECTIVE hardest = {NULL, X};
+        for (int i = 0; i < open.size(); i++) {
+            if (hardest.node == NULL || scoap->getCC(open[i].node->getIndex(), open[i].targetValue) >
+                    scoap->getCC(hardest.node->getIndex(), hardest.targetValue)) {
+                hardest = open[i];
+            }
+        }
+        if (hardest.node != NULL) {
+            return hardest;
+        }
+    }
     
     LOGIC objV;
     switch (dGate->getGateType()) {
@@ -421,14 +862,25 @@ OBJECTIVE Circuit::objective(cktList* dFrontier) {
             break;
         default:
             cout << "objective error\n";
-            break;
+            return {NULL, X};
+    }
+
+    cktNode* dIn = NULL;
+    const cktList& usl = dGate->getUpstreamList();
+    for (int i = 0; i < usl.size(); i++) {
+        if (usl[i]->getValue() == X && (dIn == NULL ||
+                scoap->getCC(usl[i]->getIndex(), objV) < scoap->getCC(dIn->getIndex(), objV))) {
+            dIn = usl[i];
+        }
     }
 
-    obj = {dIn, objV};
-    return obj;
+    return {dIn, objV};
 }
 
 
+// Walks back to a PI through X inputs. Where every input has to be set
+// for kv the hardest one goes first, so a conflict shows up early;
+// otherwise the easiest one is enough.
 OBJECTIVE Circuit::backtrace(OBJECTIVE kv) {
     if (kv.node->tested) {
         cout << "tested\n";
@@ -438,55 +890,69 @@ OBJECTIVE Circuit::backtrace(OBJECTIVE kv) {
         return kv;
     }
 
-    cktNode* nextBack = kv.node->getUnassignedInput(kv.node->needAllInputs(kv.targetValue));
+    // needAllInputs() is true when one input is enough to set kv
+    bool hardest = !kv.node->needAllInputs(kv.targetValue);
+    cktNode* nextBack = NULL;
+    LOGIC likely = X;
+    int bestCost = 0;
+    const cktList& usl = kv.node->getUpstreamList();
+    for (int i = 0; i < usl.size(); i++) {
+        if (usl[i]->getValue() != X) {
+            continue;
+        }
+        LOGIC v = kv.node->getLikely(usl[i], kv.targetValue);
+        int cost = scoap->getCC(usl[i]->getIndex(), v);
+        if (nextBack == NULL || (hardest ? cost > bestCost : cost < bestCost)) {
+            nextBack = usl[i];
+            likely = v;
+            bestCost = cost;
+        }
+    }
     if (nextBack == NULL) {
         return kv;
     }
-    LOGIC likely = kv.node->getLikely(nextBack, kv.targetValue);
 
     return backtrace({nextBack, likely});
 }
 
 bool Circuit::faultAtPO() {
     for (int i = 0; i < POnodes.size(); i++) {
-        if (POnodes[i]->getValue() == D || POnodes[i]->getValue() == DB) {
+        LOGIC poValue = POnodes[i]->getValue();
+        if (poValue == D || poValue == DB) {
             return true;
         }
     }
     return false;
 }
 
-bool Circuit::xPathCheck(cktList* dFrontier) {
-    cktQ dFQ;
-    for (int i = 0; i < dFrontier->size(); i++) {
-        dFQ.push(dFrontier->at(i));
-    }
-
-    int frontierSize = dFQ.size();
-    for (int i = 0; i < frontierSize; i++) {
-        cktNode* currNode = dFQ.front();
-        dFQ.pop();
-        if (xPathCheck(currNode)) {
-            //dFrontier->push(currNode);
+// True if a D-frontier gate still has an X path to a PO
+bool Circuit::xPathCheck() {
+    for (int i = 0; i < dFrontier.size(); i++) {
+        if (xPathCheck(dFrontier[i])) {
             return true;
         }
-        //dFrontier->push(currNode);
     }
     return false;
 }
 
-bool Circuit::xPathCheck(cktNode* node) {
-    if (node->getValue() != X) {
+// Depth-first search for an X path from idx to a PO. Values only leave
+// X until the next backtrack, so a node found without one is marked
+// and not searched again until undoTrail reaches back past the mark.
+bool Circuit::xPathCheck(int idx) {
+    if (xBlocked[idx] || indexNodes[idx]->getValue() != X) {
         return false;
     }
-    if (node->getNodeType() == PO) {
+    if (netlist->getNodeType(idx) == PO) {
         return true;
     }
-    for (int i = 0; i < node->getDownstreamList().size(); i++) {
-        if (xPathCheck(node->getDownstreamList()[i])) {
+    const int* fanouts = netlist->getFanOuts(idx);
+    for (int i = 0; i < netlist->getNumFanOuts(idx); i++) {
+        if (xPathCheck(fanouts[i])) {
             return true;
         }
     }
+    xBlocked[idx] = 1;
+    searchLog.push_back({syncMark, idx, XPATH_BLOCKED});
     return false;
 }
 
@@ -495,158 +961,941 @@ void Circuit::placeholder() {
 }
 
 inputMap* Circuit::PODEM(Fault* fault) {
-    this->reset();
-    this->addFault(fault);
+    int backtracks = 0;
+    inputMap* testVector = PODEM(fault, &backtracks);
+    addBacktracks(stats, backtracks);
+    return testVector;
+}
 
-    LOGIC dVal = fault->getNode()->getTrueValue();
-    cktQ toEvaluate;
-    cktQ notEvaluated;
-    cktList dFrontier;
-    cktNode* dNode = fault->getNode();
-    
+// PODEM for fault, returning the backtracks spent in *backtracks instead
+// of adding them to stats
+inputMap* Circuit::PODEM(Fault* fault, int* backtracks) {
+    bool untestable = false;
+    inputMap* testVector = generateTest(fault, NULL, backtracks, &untestable);
+
+    if (testVector == NULL && untestable) {
+        stringstream msg;
+        msg << "Redundant : " << fault << "\n";
+        cout << msg.str();
+        stats.redundant++;
+    } else if (testVector == NULL) {
+        testVector = satTest(fault);
+    }
+    return testVector;
+}
 
-    for (int i = 0; i < dNode->getDownstreamList().size(); i++) {
-        toEvaluate.push(dNode->getDownstreamList()[i]);
+// One PODEM or FAN search for fault. PIs that cube assigns keep their
+// values and the search only decides the others, under a backtrack limit
+// of MAXSECONDARYBACKTRACK; a failure then says nothing about the fault.
+// The test keeps X on the PIs the search left open. *untestable is set
+// when the dominators alone show that no test exists.
+inputMap* Circuit::generateTest(Fault* fault, inputMap* cube, int* backtracks, bool* untestable) {
+    // every call leaves the circuit all X again, so a full reset is only
+    // needed after a plain simulation
+    if (!allX) {
+        this->reset();
+    }
+    gettimeofday(&faultStart, 0);
+    searchLimit = backtrackLimit;
+    if (cube != NULL && (backtrackLimit <= 0 || backtrackLimit > MAXSECONDARYBACKTRACK)) {
+        searchLimit = MAXSECONDARYBACKTRACK;
     }
+    cktNode* faultNode = fault->getNode();
+    trail.push_back(make_pair(faultNode, faultNode->getTrueValue()));
+    this->addFault(fault);
 
-    if (dNode->getNodeType() == FB) {
-        while (dNode->getNodeType() == FB) {
-            dNode = dNode->getUpstreamList()[0];
+    // the fault effect starts on the faulty node alone. A branch keeps its
+    // stem fault free: the stem's fault free value becomes an objective,
+    // and the branch follows the stem once the search sets it.
+    LOGIC dVal = faultNode->getTrueValue();
+    activation = {NULL, X};
+    if (faultNode->getNodeType() == FB) {
+        activation = {faultNode->getUpstreamList()[0], dVal};
+    }
+    scheduleFanouts(faultNode);
+
+    // a cube value on the faulty PI has to be its fault free value
+    bool conflict = false;
+    for (int i = 0; cube != NULL && i < PInodes.size(); i++) {
+        LOGIC v = cube->at(PInodes[i]->getNodeID());
+        if (v == X) {
+            continue;
         }
-        dNode->setValue(dVal);
-        for (int i = 0; i < dNode->getDownstreamList().size(); i++) {
-            toEvaluate.push(dNode->getDownstreamList()[i]);
+        if (PInodes[i] == faultNode) {
+            conflict = conflict || v != dVal;
+            continue;
         }
+        trail.push_back(make_pair(PInodes[i], PInodes[i]->getTrueValue()));
+        PInodes[i]->setValue(v);
+        scheduleFanouts(PInodes[i]);
     }
 
-    this->simulate(&toEvaluate, &notEvaluated, dNode->getLevel() + 1, &dFrontier);
-    this->backwardsImplication(dNode);
-
-    if (podem(fault, &dFrontier)) {
-        inputMap* testVector = new inputMap();
+    propagate();
+
+    // the side inputs the site's dominators need may already be blocked
+    // by the values activation forces, in which case the fault is
+    // untestable without any search; a learned implication can still
+    // rule out activating it
+    inputMap* testVector = NULL;
+    markFaultCone(faultNode);
+    *untestable = !conflict && !sensitizeDominators(faultNode);
+    bool implied = (activation.node == NULL) ? backwardsImplication(faultNode) :
+            addNecessary(activation.node, dVal) && learnedImplication(activation.node, dVal);
+    if (!conflict && !*untestable && implied &&
+            (useFan ? fan(faultNode, backtracks) : podem(fault, backtracks))) {
+        testVector = new inputMap();
         for (int i = 0; i < PInodes.size(); i++) {
-            if (PInodes[i]->getTrueValue() == D || PInodes[i]->getTrueValue() == DB) {
-                testVector->insert(pair<int, LOGIC>(PInodes[i]->getNodeID(), X));
-            } else {
-                testVector->insert(pair<int, LOGIC>(PInodes[i]->getNodeID(), PInodes[i]->getTrueValue()));
-            }
+            testVector->insert(pair<int, LOGIC>(PInodes[i]->getNodeID(), PInodes[i]->getTrueValue()));
         }
-        return testVector;
-    } else {
-        cout << "PODEM Failed : " << fault << "\n";
+    }
+
+    undoTrail(0);
+    activation = {NULL, X};
+    faultNode->removeStuckAt();
+    faultNode->tested = false;
+    for (int i = 0; i < necessary.size(); i++) {
+        necessaryMark[2 * necessary[i].first->getIndex() + necessary[i].second] = 0;
+    }
+    necessary.clear();
+    return testVector;
+}
+
+// Complete test generation for faults PODEM could not handle: either
+// finds a test, proves the fault redundant, or gives up after
+// MAXSATCONFLICTS conflicts or once the fault's time limit is used up.
+inputMap* Circuit::satTest(Fault* fault) {
+    if (satAtpg == NULL) {
+        satAtpg = new SatAtpg(netlist);
+    }
+    vector<LOGIC> piValues;
+    int result = SAT_UNKNOWN;
+    double remaining = timeLimit - faultElapsed();
+    if (timeLimit <= 0 || remaining > 0) {
+        result = satAtpg->generate(fault->getNode()->getIndex(), fault->getSAV(), piValues,
+                timeLimit > 0 ? remaining : 0);
+    }
+    // one write per line, PODEM may run on several threads
+    stringstream msg;
+    if (result == SAT_UNSAT) {
+        msg << "Redundant : " << fault << "\n";
+        cout << msg.str();
+        stats.redundant++;
+        return NULL;
+    }
+    if (result == SAT_UNKNOWN) {
+        msg << "PODEM Failed : " << fault << "\n";
+        cout << msg.str();
+        stats.aborted++;
         return NULL;
     }
+
+    inputMap* testVector = new inputMap();
+    for (int i = 0; i < PInodes.size(); i++) {
+        testVector->insert(pair<int, LOGIC>(PInodes[i]->getNodeID(), piValues[i]));
+    }
+    return testVector;
 }
 
 int pf(Fault* fault) {
     return fault->getNode()->getNodeID();
 }
 
-bool Circuit::podem(Fault* fault, cktList* dFrontier) {
-    if (faultAtPO()) {
-        //cout << "success, " << fault << " at PO\n";
-        return true;
+// Iterative PODEM search. Each decision is pushed with the trail length
+// it was made at; on a conflict the latest decision with an untried
+// value is undone back to that point, along with the blocked marks and
+// D-frontier, and flipped.
+// Assignments contradicting a necessary value count as conflicts.
+// The search is abandoned after searchLimit flips or once the
+// fault's time limit has passed; *backtracks returns the flips made.
+bool Circuit::podem(Fault* fault, int* backtracks) {
+    vector<DECISION> decisions;
+
+    while (true) {
+        if (faultAtPO() && activated()) {
+            return true;
+        }
+
+        syncSearch();
+        OBJECTIVE piBacktrace = {NULL, X};
+        if (necessaryHolds() && (faultAtPO() || xPathCheck())) {
+            OBJECTIVE obj = objective();
+            if (obj.node != NULL && obj.targetValue != X) {
+                piBacktrace = backtrace(obj);
+            }
+        }
+
+        if (piBacktrace.node != NULL) {
+            DECISION d = {piBacktrace.node, piBacktrace.targetValue, false, (int)trail.size()};
+            decisions.push_back(d);
+            assign(piBacktrace.node, piBacktrace.targetValue);
+            continue;
+        }
+
+        if (!backtrack(&decisions, backtracks)) {
+            return false;
+        }
     }
+}
 
-    if (!xPathCheck(dFrontier)) {
-        //cout << "xPath FAIL : " << fault << "\n";
+// Undoes decisions back to the latest one with an untried value and
+// flips it. False when none is left or a limit is reached.
+bool Circuit::backtrack(vector<DECISION>* decisions, int* backtracks) {
+    while (!decisions->empty() && decisions->back().flipped) {
+        undoTrail(decisions->back().trailMark);
+        decisions->pop_back();
+    }
+    if (decisions->empty()) {
         return false;
     }
+    if ((searchLimit > 0 && *backtracks >= searchLimit) ||
+            (timeLimit > 0 && faultElapsed() > timeLimit)) {
+        return false;
+    }
+    (*backtracks)++;
+    DECISION& last = decisions->back();
+    undoTrail(last.trailMark);
+    last.flipped = true;
+    assign(last.node, ~last.value);
+    return true;
+}
 
-    OBJECTIVE obj = objective(dFrontier);
-    if (obj.node == NULL || obj.targetValue == X) {return false;}
-    OBJECTIVE piBacktrace = backtrace(obj);
-    
-    if (piBacktrace.node == NULL) {
+static LOGIC nonControlling(gateT gate) {
+    switch (gate) {
+        case AND:
+        case NAND:
+            return ONE;
+        case OR:
+        case NOR:
+            return ZERO;
+        default:
+            return X;
+    }
+}
+
+// FAN search. Decisions are made only on PIs and on headlines whose
+// fanout-free cone the fault does not touch, as picked by multiple
+// backtrace; conflicts and limits are handled as in podem(). Once the
+// fault effect is at a PO the assigned headlines are justified, which
+// cannot fail since their cones are trees of X nodes.
+bool Circuit::fan(cktNode* dNode, int* backtracks) {
+    markFanCones(dNode);
+
+    vector<DECISION> decisions;
+    while (true) {
+        if (faultAtPO() && activated()) {
+            for (int i = 0; i < decisions.size(); i++) {
+                if (decisions[i].node->getNodeType() != PI) {
+                    justifyFree(decisions[i].node, decisions[i].node->getTrueValue());
+                }
+            }
+            return true;
+        }
+
+        syncSearch();
+        OBJECTIVE decision = {NULL, X};
+        if (necessaryHolds() && (faultAtPO() || xPathCheck())) {
+            decision = multipleBacktrace();
+        }
 
+        if (decision.node != NULL) {
+            DECISION d = {decision.node, decision.targetValue, false, (int)trail.size()};
+            decisions.push_back(d);
+            assign(decision.node, decision.targetValue);
+            continue;
+        }
+
+        if (!backtrack(&decisions, backtracks)) {
+            return false;
+        }
     }
+}
 
-    cktQ toEvaluate;
-    cktQ notEvaluated;
-    piBacktrace.node->setValue(piBacktrace.targetValue);
-    //cout << piBacktrace.node->getNodeID() << " " << piBacktrace.targetValue << "\n";
-    for (int i = 0; i < piBacktrace.node->getDownstreamList().size(); i++) {
-        toEvaluate.push(piBacktrace.node->getDownstreamList()[i]);
+// Marks the fanout cone of the fault effect
+void Circuit::markFaultCone(cktNode* dNode) {
+    int n = netlist->getNumNodes();
+    faultCone.assign(n, 0);
+    faultCone[dNode->getIndex()] = 1;
+    for (int idx = dNode->getIndex() + 1; idx < n; idx++) {
+        const int* in = netlist->getFanIns(idx);
+        for (int j = 0; j < netlist->getNumFanIns(idx) && !faultCone[idx]; j++) {
+            faultCone[idx] = faultCone[in[j]];
+        }
     }
-    this->simulate(&toEvaluate, &notEvaluated, piBacktrace.node->getLevel() + 1, dFrontier);
-    if (podem(fault, dFrontier)) {
-        return true;
+}
+
+// Marks the headlines FAN may assign: those whose cone holds neither
+// the fault site nor a node its activation may set, i.e. that are not
+// reachable from the site's fanin cone.
+void Circuit::markFanCones(cktNode* dNode) {
+    int n = netlist->getNumNodes();
+    int site = dNode->getIndex();
+    vector<char> reached(n, 0);
+    reached[site] = 1;
+    for (int idx = site; idx >= 0; idx--) {
+        if (reached[idx]) {
+            const int* in = netlist->getFanIns(idx);
+            for (int j = 0; j < netlist->getNumFanIns(idx); j++) {
+                reached[in[j]] = 1;
+            }
+        }
+    }
+
+    usable.assign(n, 0);
+    for (int idx = 0; idx < n; idx++) {
+        const int* in = netlist->getFanIns(idx);
+        for (int j = 0; j < netlist->getNumFanIns(idx); j++) {
+            reached[idx] |= reached[in[j]];
+        }
+        usable[idx] = headline[idx] && !reached[idx];
+    }
+}
+
+// Every test carries the fault effect through each dominator of the
+// site, so their side inputs must hold the non-controlling value; these
+// go on the necessary list. False if two such values, or a value
+// already set, disagree.
+bool Circuit::sensitizeDominators(cktNode* dNode) {
+    for (int d = dominators->getIdom(dNode->getIndex()); d != DOM_ROOT; d = dominators->getIdom(d)) {
+        LOGIC v = nonControlling(netlist->getGateType(d));
+        if (v == X) {
+            continue;
+        }
+        const int* in = netlist->getFanIns(d);
+        for (int j = 0; j < netlist->getNumFanIns(d); j++) {
+            if (!faultCone[in[j]] && !addNecessary(indexNodes[in[j]], v)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Collects the X side inputs of the dominators of gate, which the fault
+// effect has to pass once gate is the only way forward. False if one of
+// them already holds the controlling value.
+bool Circuit::dominatorSideInputs(cktNode* gate, vector<OBJECTIVE>* open) {
+    for (int d = dominators->getIdom(gate->getIndex()); d != DOM_ROOT; d = dominators->getIdom(d)) {
+        LOGIC v = nonControlling(netlist->getGateType(d));
+        if (v == X) {
+            continue;
+        }
+        const int* in = netlist->getFanIns(d);
+        for (int j = 0; j < netlist->getNumFanIns(d); j++) {
+            if (faultCone[in[j]]) {
+                continue;
+            }
+            LOGIC curr = indexNodes[in[j]]->getTrueValue();
+            if (curr == X) {
+                open->push_back({indexNodes[in[j]], v});
+            } else if (curr != v) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Circuit::addNecessary(cktNode* node, LOGIC v) {
+    LOGIC curr = node->getTrueValue();
+    int lit = 2 * node->getIndex() + v;
+    if ((curr != X && curr != v) || necessaryMark[lit ^ 1]) {
+        return false;
+    }
+    if (!necessaryMark[lit]) {
+        necessaryMark[lit] = 1;
+        necessary.push_back(make_pair(node, v));
+    }
+    return true;
+}
+
+void Circuit::fanRequest(int idx, LOGIC v, int count, priority_queue<int>* pending, vector<int>* touched) {
+    if (!fanQueued[idx]) {
+        fanQueued[idx] = 1;
+        pending->push(idx);
+        touched->push_back(idx);
+    }
+    fanCount[v][idx] += count;
+}
+
+// Multiple backtrace. The objectives (open necessary values, the inputs
+// of the most observable D-frontier gate and, when that gate is the
+// only one, the side inputs of its dominators) are counted as 0 and 1
+// requests and passed down to the X inputs that can satisfy them. Once
+// the fault effect is at a PO only the necessary values are left, among
+// them the stem value a branch fault still needs.
+// Nodes are taken fanouts first, so a stem sees the requests of all its
+// branches and keeps the majority value. Requests stop at PIs and
+// usable headlines, and the one with the most becomes the decision.
+// {NULL, X} means backtrack: a dominator side input is already
+// controlling, or nothing is left to assign.
+OBJECTIVE Circuit::multipleBacktrace() {
+    int dGates = 0;
+    bool atPO = faultAtPO();
+    cktNode* dGate = atPO ? NULL : dFrontierGate(&dGates);
+    if (dGate == NULL && !atPO) {
+        return {NULL, X};
+    }
+    int n = netlist->getNumNodes();
+    if (fanQueued.size() != n) {
+        fanCount[0].assign(n, 0);
+        fanCount[1].assign(n, 0);
+        fanQueued.assign(n, 0);
+    }
+    priority_queue<int> pending;
+    vector<int> touched;
+    OBJECTIVE best = {NULL, X};
+
+    for (int i = 0; i < necessary.size(); i++) {
+        if (necessary[i].first->getTrueValue() == X) {
+            fanRequest(necessary[i].first->getIndex(), necessary[i].second, 1, &pending, &touched);
+        }
+    }
+    if (dGate != NULL) {
+        LOGIC ncv = nonControlling(dGate->getGateType());
+        const cktList& usl = dGate->getUpstreamList();
+        for (int i = 0; i < usl.size(); i++) {
+            if (usl[i]->getValue() == X) {
+                fanRequest(usl[i]->getIndex(), ncv == X ? ZERO : ncv, 1, &pending, &touched);
+            }
+        }
     }
 
-    assert(toEvaluate.empty() && notEvaluated.empty());
-    //assert(updatedDFront.empty());
+    bool conflict = false;
+    if (dGate != NULL && dGates == 1) {
+        vector<OBJECTIVE> open;
+        conflict = !dominatorSideInputs(dGate, &open);
+        for (int i = 0; i < open.size() && !conflict; i++) {
+            fanRequest(open[i].node->getIndex(), open[i].targetValue, 1, &pending, &touched);
+        }
+    }
+
+    int bestCount = 0;
+    vector<int> xIns;
+    while (!pending.empty() && !conflict) {
+        int idx = pending.top();
+        pending.pop();
+        cktNode* node = indexNodes[idx];
+        int count[2] = {fanCount[0][idx], fanCount[1][idx]};
+        if (node->getTrueValue() != X) {
+            continue;
+        }
+        if (node->getNodeType() == PI || usable[idx]) {
+            if (count[0] + count[1] > bestCount) {
+                best = {node, count[1] > count[0] ? ONE : ZERO};
+                bestCount = count[0] + count[1];
+            }
+            continue;
+        }
+        if (netlist->getNumFanOuts(idx) > 1) {
+            count[count[1] > count[0] ? 0 : 1] = 0;
+        }
+
+        xIns.clear();
+        int parity = 0;
+        const int* in = netlist->getFanIns(idx);
+        for (int j = 0; j < netlist->getNumFanIns(idx); j++) {
+            LOGIC v = indexNodes[in[j]]->getValue();
+            if (v == X) {
+                xIns.push_back(in[j]);
+            } else if (v == ONE) {
+                parity ^= 1;
+            }
+        }
+        if (xIns.empty()) {
+            continue;
+        }
+
+        gateT gate = node->getGateType();
+        for (int v = 0; v < 2; v++) {
+            if (count[v] == 0) {
+                continue;
+            }
+            switch (gate) {
+                case AND:
+                case NAND:
+                case OR:
+                case NOR: {
+                    // one input at the controlling value, or all at the other
+                    LOGIC c = (gate == AND || gate == NAND) ? ZERO : ONE;
+                    LOGIC inner = (LOGIC)(v ^ (gate == NAND || gate == NOR));
+                    if (inner == c) {
+                        int easiest = xIns[0];
+                        for (int j = 1; j < xIns.size(); j++) {
+                            if (scoap->getCC(xIns[j], c) < scoap->getCC(easiest, c)) {
+                                easiest = xIns[j];
+                            }
+                        }
+                        fanRequest(easiest, c, count[v], &pending, &touched);
+                    } else {
+                        for (int j = 0; j < xIns.size(); j++) {
+                            fanRequest(xIns[j], ~c, count[v], &pending, &touched);
+                        }
+                    }
+                    break;
+                }
+                case XOR:
+                case XNOR:
+                    for (int j = 0; j + 1 < xIns.size(); j++) {
+                        fanRequest(xIns[j], ZERO, count[v], &pending, &touched);
+                    }
+                    fanRequest(xIns.back(), (LOGIC)(v ^ parity ^ (gate == XNOR)), count[v], &pending, &touched);
+                    break;
+                default:            // NOT, BRCH and buffers
+                    fanRequest(xIns[0], (LOGIC)(v ^ (gate == NOT)), count[v], &pending, &touched);
+                    break;
+            }
+        }
+    }
 
-    piBacktrace.node->setValue(~piBacktrace.targetValue);
-    for (int i = 0; i < piBacktrace.node->getDownstreamList().size(); i++) {
-        toEvaluate.push(piBacktrace.node->getDownstreamList()[i]);
+    for (int i = 0; i < touched.size(); i++) {
+        fanCount[0][touched[i]] = 0;
+        fanCount[1][touched[i]] = 0;
+        fanQueued[touched[i]] = 0;
+    }
+    if (conflict) {
+        return {NULL, X};
     }
-    this->simulate(&toEvaluate, &notEvaluated, 1, dFrontier);
-    bool podemOut = podem(fault, dFrontier);
-    //piBacktrace.node->setValue(X);
-    piBacktrace.node->tested = true;
+    return best;
+}
 
-    if (podemOut) {
-        //cout << "Backtrace failed\n";
+// Sets the PIs in the fanout-free cone of node so that it evaluates to
+// v. Every node in the cone is X and feeds only the next one, so each
+// choice succeeds.
+void Circuit::justifyFree(cktNode* node, LOGIC v) {
+    if (node->getNodeType() == PI) {
+        trail.push_back(make_pair(node, node->getTrueValue()));
+        node->setValue(v);
+        return;
+    }
+    const cktList& usl = node->getUpstreamList();
+    gateT gate = node->getGateType();
+    switch (gate) {
+        case AND:
+        case NAND:
+        case OR:
+        case NOR: {
+            LOGIC c = (gate == AND || gate == NAND) ? ZERO : ONE;
+            LOGIC inner = (gate == NAND || gate == NOR) ? ~v : v;
+            if (inner == c) {
+                cktNode* easiest = usl[0];
+                for (int i = 1; i < usl.size(); i++) {
+                    if (scoap->getCC(usl[i]->getIndex(), c) < scoap->getCC(easiest->getIndex(), c)) {
+                        easiest = usl[i];
+                    }
+                }
+                justifyFree(easiest, c);
+            } else {
+                for (int i = 0; i < usl.size(); i++) {
+                    justifyFree(usl[i], ~c);
+                }
+            }
+            break;
+        }
+        case XOR:
+        case XNOR:
+            for (int i = 0; i + 1 < usl.size(); i++) {
+                justifyFree(usl[i], ZERO);
+            }
+            justifyFree(usl.back(), gate == XNOR ? ~v : v);
+            break;
+        default:                    // NOT, BRCH and buffers
+            justifyFree(usl[0], gate == NOT ? ~v : v);
+            break;
     }
-    return podemOut;
+}
+
+// Seconds since PODEM took up the current fault
+double Circuit::faultElapsed() {
+    struct timeval now;
+    gettimeofday(&now, 0);
+    return (now.tv_sec - faultStart.tv_sec) + (now.tv_usec - faultStart.tv_usec) * 1e-6;
+}
+
+// Per-fault search limits for PODEM and its SAT fallback; 0 disables
+// a limit.
+void Circuit::setLimits(int backtracks, double seconds) {
+    backtrackLimit = backtracks;
+    timeLimit = seconds;
 }
 
 cktNode Circuit::getNode(int nodeID)
     {return *nodes[nodeID];}
 
 
-double Circuit::atpg(inputSet* testVectors) {
+double Circuit::atpg(PatternStore* tests) {
     faultSet reducedFaults = generateFaults(true);
     faultSet detectedFaults;
+    clearStats(stats);
+    stats.total = reducedFaults.size();
 
-    int numRandom = 0;
-    double fcPrev = 0;
-    double fc = 0;
-    while ((fc == 0 || (fc - fcPrev > 0.01)) && numRandom < MAXRANDOM) {
-        inputList randomInputs = randomTestsGen(1);
-        faultMap* randomFD = deductiveFaultSim(&reducedFaults, &randomInputs);
-
-        if (!randomFD->empty()) {
-            for (faultList::iterator it = randomFD->at(randomInputs[0])->begin();
-                    it != randomFD->at(randomInputs[0])->end(); ++it) {
-                detectedFaults.insert(*it);
-                reducedFaults.erase(*it);
-            }
-        }
+    randomFaults(&reducedFaults, &detectedFaults, tests);
+    targetFaults(&reducedFaults, &detectedFaults, tests);
+    compactTests(tests);
+    stats.detected = detectedFaults.size();
+    return faultCoverage(&detectedFaults);
+}
+
+// Random phase ahead of PODEM: uniform random patterns first, then up
+// to MAXWEIGHTSETS weighted phases, each with PI weights fitted by COP to
+// the faults the earlier phases left open
+void Circuit::randomFaults(faultSet* faults, faultSet* detected, PatternStore* tests) {
+    if (faultSim == NULL) {
+        faultSim = new FaultSim(netlist, cktName);
+    }
 
-        faultList uniqueFaults;
-        for (set<Fault*>::iterator it = detectedFaults.begin(); it != detectedFaults.end(); ++it) {
-            uniqueFaults.push_back(*it);
+    uint64_t seed = RANDOMSEED;
+    double total = detected->size() + faults->size();
+    cop->setUniform();
+    int patterns = randomBlocks(faults, detected, tests, &seed);
+    printf("Random phase: %d patterns, kept %d, FC=%.3f\n",
+            patterns, tests->size(), detected->size() / total);
+
+    for (int set = 0; set < MAXWEIGHTSETS && !faults->empty(); set++) {
+        vector<pair<int, int> > open;
+        for (faultSet::iterator it = faults->begin(); it != faults->end(); ++it) {
+            open.push_back(make_pair((*it)->getNode()->getIndex(), (*it)->getSAV()));
+        }
+        cop->optimize(open, MAXRANDOMBLOCKS * PPSFP_WIDTH);
+        int before = detected->size();
+        patterns = randomBlocks(faults, detected, tests, &seed);
+        printf("Weighted random phase %d: %d patterns, kept %d, FC=%.3f\n",
+                set + 1, patterns, tests->size(), detected->size() / total);
+        if (detected->size() == before) {
+            break;
         }
-        testVectors->insert(randomInputs[0]);
-        fcPrev = fc;
-        fc = faultCoverage(&detectedFaults);
-        numRandom++;
     }
+}
 
-    printf("Stopping random inputs on #%d with FC=%.3f and prevFC=%.3F\n", numRandom, fc, fcPrev);
+// Blocks of PPSFP_WIDTH patterns drawn with the COP weights are fault
+// simulated bit-parallel, dropping every fault detected. A pattern is
+// kept only if it is the first in its block to detect some fault. Ends
+// once RANDOMIDLEBLOCKS blocks in a row detect nothing; returns the
+// number of patterns simulated.
+int Circuit::randomBlocks(faultSet* faults, faultSet* detected, PatternStore* tests, uint64_t* seed) {
+    vector<uint64_t> words(PInodes.size());
+    inputMap test;
+    int blocks = 0;
+    int idle = 0;
+    while (!faults->empty() && idle < RANDOMIDLEBLOCKS && blocks < MAXRANDOMBLOCKS) {
+        for (int i = 0; i < PInodes.size(); i++) {
+            words[i] = weightedWord(*seed, cop->getWeight(PInodes[i]->getIndex()));
+            faultSim->setPatternWord(PInodes[i]->getIndex(), words[i]);
+        }
+        faultSim->simulateGood();
+
+        uint64_t keep = 0;
+        for (faultSet::iterator it = faults->begin(); it != faults->end();) {
+            uint64_t mask = faultSim->detect((*it)->getNode()->getIndex(), (*it)->getSAV());
+            if (mask) {
+                keep |= mask & -mask;
+                detected->insert(*it);
+                faults->erase(it++);
+            } else {
+                ++it;
+            }
+        }
 
-    for (faultSet::iterator it = reducedFaults.begin(); it != reducedFaults.end(); ++it) {
-        inputMap* newTV = this->PODEM(*it);
-        if (newTV != NULL) {
-            testVectors->insert(newTV);
-            detectedFaults.insert(*it);
+        idle = keep ? 0 : idle + 1;
+        while (keep) {
+            int b = __builtin_ctzll(keep);
+            keep &= keep - 1;
+            for (int i = 0; i < PInodes.size(); i++) {
+                test[PInodes[i]->getNodeID()] = ((words[i] >> b) & 1) ? ONE : ZERO;
+            }
+            tests->add(test);
         }
+        blocks++;
     }
-    return faultCoverage(&detectedFaults);
+    return blocks * PPSFP_WIDTH;
 }
 
-double Circuit::atpg_det(inputSet * testVectors) {
+double Circuit::atpg_det(PatternStore* tests) {
     faultSet faults = this->generateFaults(true);
     faultSet detectedFaults;
+    clearStats(stats);
+    stats.total = faults.size();
+    targetFaults(&faults, &detectedFaults, tests);
+    compactTests(tests);
+    stats.detected = detectedFaults.size();
+    return faultCoverage(&detectedFaults);
+}
+
+Compactor* Circuit::getCompactor() {
+    if (faultSim == NULL) {
+        faultSim = new FaultSim(netlist, cktName);
+    }
+    if (compactor == NULL) {
+        compactor = new Compactor(netlist, faultSim);
+    }
+    return compactor;
+}
+
+// Static compaction against the checkpoint faults; every one of them a
+// vector detects stays detected.
+void Circuit::compactTests(PatternStore* tests) {
+    faultSet faults = generateFaults(true);
+    vector<pair<int, int> > fl;
     for (faultSet::iterator it = faults.begin(); it != faults.end(); ++it) {
-      inputMap* tv = this->PODEM(*it);
-      if (tv != NULL) {
-         testVectors->insert(tv);
-         detectedFaults.insert(*it);
-      }
-   }
-   return faultCoverage(&detectedFaults);
+        fl.push_back(make_pair((*it)->getNode()->getIndex(), (*it)->getSAV()));
+        delete *it;
+    }
+    vector<int> keep = getCompactor()->compact(*tests, fl);
+    printf("Static compaction kept %d of %d vectors\n", (int) keep.size(), tests->size());
+    tests->keep(keep);
+}
+
+static bool faultOrder(Fault* a, Fault* b) {
+    if (a->getNode()->getNodeID() != b->getNode()->getNodeID()) {
+        return a->getNode()->getNodeID() < b->getNode()->getNodeID();
+    }
+    return a->getSAV() < b->getSAV();
+}
+
+// Number of PODEM workers; ATPG_THREADS overrides the core count
+int atpgThreads() {
+    char* env = getenv("ATPG_THREADS");
+    if (env != NULL && atoi(env) > 0) {
+        return atoi(env);
+    }
+    int n = thread::hardware_concurrency();
+    return (n > 0) ? n : 1;
+}
+
+// Runs PODEM on every fault in faults, in node ID order, and moves the
+// ones it detects over to detected. Each worker thread owns a copy of
+// this circuit's nodes and search state, so node values are never
+// shared; this circuit is worker 0. A new vector is fault simulated against
+// the faults still open so they are skipped by all workers. In ordered
+// mode results are committed in fault order, which makes the vectors
+// independent of the thread count and timing.
+void Circuit::targetFaults(faultSet* faults, faultSet* detected, PatternStore* tests) {
+    ATPGWORK work;
+    work.faults.assign(faults->begin(), faults->end());
+    sort(work.faults.begin(), work.faults.end(), faultOrder);
+    int n = work.faults.size();
+    work.next = 0;
+    work.status = vector<atomic<char> >(n);
+    for (int i = 0; i < n; i++) {
+        work.status[i] = FAULT_OPEN;
+    }
+    work.results.resize(n);
+    work.ordered = ordered;
+    work.nextCommit = 0;
+    work.tests = tests;
+    work.redundant = 0;
+    work.aborted = 0;
+
+    int numWorkers = max(1, min(atpgThreads(), n));
+    vector<Circuit*> workers;
+    vector<thread> threads;
+    for (int t = 1; t < numWorkers; t++) {
+        Circuit* worker = new Circuit(this);
+        workers.push_back(worker);
+        threads.push_back(thread(&Circuit::podemWorker, worker, &work));
+    }
+    int redundant = stats.redundant;
+    int aborted = stats.aborted;
+    podemWorker(&work);
+    for (int t = 0; t < threads.size(); t++) {
+        threads[t].join();
+        delete workers[t];
+    }
+    stats.redundant = redundant + work.redundant;
+    stats.aborted = aborted + work.aborted;
+    for (int i = 0; i < n; i++) {
+        if (work.results[i].backtracks >= 0) {
+            addBacktracks(stats, work.results[i].backtracks);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (work.status[i] == FAULT_DETECTED) {
+            detected->insert(work.faults[i]);
+        }
+    }
+    faults->clear();
+}
+
+// Takes faults from work until none are left. Faults and nodes are
+// this circuit's own; they are matched to work->faults by node ID.
+void Circuit::podemWorker(ATPGWORK* work) {
+    int n = work->faults.size();
+    vector<Fault*> local(n);
+    map<Fault*, int> indexOf;
+    for (int i = 0; i < n; i++) {
+        int nodeID = work->faults[i]->getNode()->getNodeID();
+        if (nodes[nodeID] == work->faults[i]->getNode()) {
+            local[i] = work->faults[i];
+        } else {
+            local[i] = createFault(nodeID, work->faults[i]->getSAV());
+        }
+        indexOf[local[i]] = i;
+    }
+
+    int i;
+    while ((i = work->next++) < n) {
+        ATPGRESULT result = {true, PODEM_SKIPPED, NULL, -1, vector<int>()};
+        if (work->status[i] == FAULT_OPEN) {
+            int redundant = stats.redundant;
+            result.backtracks = 0;
+            result.testVector = PODEM(local[i], &result.backtracks);
+            if (result.testVector != NULL) {
+                result.outcome = PODEM_DETECTED;
+                if (work->ordered) {
+                    // which faults are still open is only settled once every
+                    // earlier fault is committed
+                    unique_lock<mutex> wait(work->lock);
+                    work->committed.wait(wait, [work, i] {return work->nextCommit == i;});
+                }
+                // a fault an earlier vector covers is dropped at commit, so
+                // its vector is neither extended nor graded
+                if (work->status[i] == FAULT_OPEN) {
+                    compactTest(work, local, i, result.testVector);
+                    bool detected = gradeTest(work, local, indexOf, i, result.testVector, &result.detects);
+                    assert(detected);
+                }
+            } else {
+                result.outcome = (stats.redundant > redundant) ? PODEM_REDUNDANT : PODEM_ABORTED;
+            }
+        }
+
+        lock_guard<mutex> guard(work->lock);
+        work->results[i] = result;
+        if (!work->ordered) {
+            commitResult(work, i);
+        } else {
+            while (work->nextCommit < n && work->results[work->nextCommit].ready) {
+                commitResult(work, work->nextCommit++);
+            }
+            work->committed.notify_all();
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (local[i] != work->faults[i]) {
+            delete local[i];
+        }
+    }
+}
+
+// Fault simulates test against fault i and the other open faults. The
+// open faults it detects other than i go to detects; true if it detects
+// fault i.
+bool Circuit::gradeTest(ATPGWORK* work, const vector<Fault*>& local, map<Fault*, int>& indexOf,
+        int i, inputMap* test, vector<int>* detects) {
+    faultSet open;
+    for (int j = 0; j < local.size(); j++) {
+        if (j == i || work->status[j] == FAULT_OPEN) {
+            open.insert(local[j]);
+        }
+    }
+    detects->clear();
+    bool detected = false;
+    inputList ins(1, test);
+    faultMap* fd = deductiveFaultSim(&open, &ins);
+    for (faultMap::iterator it = fd->begin(); it != fd->end(); ++it) {
+        for (faultList::iterator f = it->second->begin(); f != it->second->end(); ++f) {
+            if (indexOf[*f] == i) {
+                detected = true;
+            } else {
+                detects->push_back(indexOf[*f]);
+            }
+        }
+        delete it->second;
+    }
+    delete fd;
+    return detected;
+}
+
+// Dynamic compaction of the test cube for fault i: further open faults
+// are targeted with the PIs the cube assigns held fixed, until no PI is
+// left X or MAXSECONDARY faults have been tried. The remaining Xs are
+// then filled at random. Faults the cube already keeps from being
+// activated are passed over without a search. Only the fault simulation
+// of the final vector decides which of these faults it detects.
+void Circuit::compactTest(ATPGWORK* work, const vector<Fault*>& local, int i, inputMap* cube) {
+    int n = local.size();
+    int open = 0;
+    for (inputMap::iterator it = cube->begin(); it != cube->end(); ++it) {
+        open += (it->second == X);
+    }
+    simulateCompiled(cube);
+    int tried = 0;
+    for (int k = 1; k < n && open > 0 && tried < MAXSECONDARY; k++) {
+        int j = (i + k) % n;
+        if (work->status[j] != FAULT_OPEN ||
+                getCompiledValue(local[j]->getNode()->getNodeID()) == local[j]->getSAV()) {
+            continue;
+        }
+        tried++;
+        int backtracks = 0;
+        bool untestable;
+        inputMap* extended = generateTest(local[j], cube, &backtracks, &untestable);
+        if (extended == NULL) {
+            continue;
+        }
+        *cube = *extended;
+        delete extended;
+        open = 0;
+        for (inputMap::iterator it = cube->begin(); it != cube->end(); ++it) {
+            open += (it->second == X);
+        }
+        simulateCompiled(cube);
+    }
+
+    fillTest(i, cube);
+}
+
+// Fills the Xs left in the test for fault i at random, seeded by the
+// fault so ordered runs stay reproducible
+void Circuit::fillTest(int i, inputMap* test) {
+    unsigned int seed = i + 1;
+    for (inputMap::iterator it = test->begin(); it != test->end(); ++it) {
+        if (it->second == X) {
+            it->second = (rand_r(&seed) & 1) ? ONE : ZERO;
+        }
+    }
+}
+
+// Applies one finished PODEM result; called with work->lock held. A
+// fault detected in the meantime by another vector drops its result.
+void Circuit::commitResult(ATPGWORK* work, int i) {
+    ATPGRESULT& result = work->results[i];
+    if (work->status[i] != FAULT_OPEN) {
+        // only searches a serial run would also have made are counted
+        delete result.testVector;
+        result.backtracks = -1;
+    } else if (result.outcome == PODEM_DETECTED) {
+        work->status[i] = FAULT_DETECTED;
+        work->tests->add(*result.testVector);
+        delete result.testVector;
+        for (int j = 0; j < result.detects.size(); j++) {
+            if (work->status[result.detects[j]] == FAULT_OPEN) {
+                work->status[result.detects[j]] = FAULT_DETECTED;
+            }
+        }
+    } else {
+        work->status[i] = FAULT_FAILED;
+        if (result.outcome == PODEM_REDUNDANT) {
+            work->redundant++;
+        } else {
+            work->aborted++;
+        }
+    }
+    result.testVector = NULL;
+    result.detects.clear();
+}
+
+// Runs static learning over the netlist; from then on PODEM checks the
+// assignments learned from each fault's activation. Returns the learning
+// time in seconds.
+double Circuit::learn() {
+    struct timeval begin, end;
+    gettimeofday(&begin, 0);
+    delete implications;
+    implications = new Implications(netlist);
+    gettimeofday(&end, 0);
+    return (end.tv_sec - begin.tv_sec) + (end.tv_usec - begin.tv_usec) * 1e-6;
 }
 
 string Circuit::getCktName() {
@@ -6,12 +6,68 @@
 #include "cktNode.h"
 #include "defines.h"
 #include "Fault.h"
+#include "Netlist.h"
+#include "SimTape.h"
+#include "CompiledSim.h"
+#include "FaultSim.h"
+#include "Scoap.h"
+#include "Cop.h"
+#include "Implications.h"
+#include "SatAtpg.h"
+#include "Dominators.h"
+#include "Compactor.h"
+#include "PatternStore.h"
 
 typedef struct objective_s{
     cktNode* node;
     LOGIC targetValue;
 } OBJECTIVE;
 
+typedef struct decision_s{
+    cktNode* node;
+    LOGIC value;
+    bool flipped;           // both values tried
+    int trailMark;          // trail length before the assignment
+} DECISION;
+
+enum {XPATH_BLOCKED, FRONTIER_ADDED, FRONTIER_REMOVED};
+
+// A change to the D-frontier or the blocked marks, kept so it can be
+// undone together with the trail entries it was derived from
+typedef struct search_change_s{
+    int trailMark;          // trail length when the change was derived
+    int idx;
+    int op;
+} SEARCHCHANGE;
+
+enum {FAULT_OPEN, FAULT_DETECTED, FAULT_FAILED};
+enum {PODEM_SKIPPED, PODEM_DETECTED, PODEM_REDUNDANT, PODEM_ABORTED};
+
+typedef struct atpg_result_s{
+    bool ready;
+    int outcome;
+    inputMap* testVector;   // NULL unless outcome is PODEM_DETECTED
+    int backtracks;         // spent by the search, -1 if it is not counted
+    vector<int> detects;    // other open faults the vector detects
+} ATPGRESULT;
+
+// State shared by the PODEM workers of one ATPG run. Faults are known
+// by their position in faults; status only moves away from FAULT_OPEN,
+// and only while lock is held.
+typedef struct atpg_work_s{
+    vector<Fault*> faults;
+    atomic<int> next;                   // next fault to hand out
+    vector<atomic<char> > status;
+    vector<ATPGRESULT> results;
+    bool ordered;                       // commit results in fault order
+    int nextCommit;
+    mutex lock;
+    condition_variable committed;       // signalled as nextCommit advances
+    PatternStore* tests;
+    int redundant;
+    int aborted;
+} ATPGWORK;
+
 class Circuit {
     private:
         string cktName;
@@ -24,54 +80,149 @@ class Circuit {
         int numNodes;
         int numGates;
         bool initialized;
+        bool allX;                          // every node X, no fault set
         char cstringName[MAXLINE];
 
+        Netlist* netlist;
+        cktList indexNodes;                 // dense index -> node
+        vector<vector<int> > eventQueue;    // pending evaluations, by level
+        vector<char> queued;
+        int minQueuedLevel;
+        vector<pair<cktNode*, LOGIC> > trail;   // old values, in change order
+        vector<int> dFrontier;              // X gates with a D or DB input
+        vector<int> frontierPos;            // place in dFrontier, -1 if not in it
+        vector<long> frontierJoined;        // when a gate last joined dFrontier, breaks ties
+        long frontierClock;
+        vector<char> xBlocked;              // X node known to have no X path to a PO
+        vector<SEARCHCHANGE> searchLog;     // dFrontier and xBlocked changes, in order
+        int syncMark;                       // trail entries folded into dFrontier
+        SimTape* tape;                      // built on first compiled simulate
+        CompiledSim* nativeSim;             // generated on first use
+        FaultSim* faultSim;                 // PPSFP engine, built on first use
+        Compactor* compactor;               // static compaction, built on first use
+        Scoap* scoap;                       // testability measures for PODEM
+        Cop* cop;                           // signal probabilities for weighted random patterns
+        Implications* implications;         // static learning, NULL until learn()
+        vector<pair<cktNode*, LOGIC> > necessary;   // learned values any test needs
+        vector<char> necessaryMark;         // literals on the necessary list
+        OBJECTIVE activation;               // stem value a branch fault needs, node NULL otherwise
+        SatAtpg* satAtpg;                   // fallback for PODEM failures, built on first use
+        Dominators* dominators;             // PO-dominator tree
+        vector<char> headline;              // outputs of fanout-free regions
+        bool useFan;                        // search with FAN instead of PODEM
+        vector<char> faultCone;             // fanout cone of the fault effect
+        vector<char> usable;                // FAN: headlines that may be assigned
+        vector<int> fanCount[2];            // FAN: 0 and 1 requests per node
+        vector<char> fanQueued;
+        int backtrackLimit;                 // per fault, 0 for no limit
+        int searchLimit;                    // backtrack limit of the current search
+        double timeLimit;                   // seconds per fault, 0 for no limit
+        struct timeval faultStart;          // when PODEM took up the current fault
+        Circuit* parent;                    // owner of the shared netlist data, NULL if this is it
+        bool ordered;                       // deterministic vector order
+        ATPGSTATS stats;                    // outcome of the last ATPG run
+
         void linkNodes();
         void levelize(cktNode *currNode, int curr_level);
         void levelize();
         void verifyLink();
-        void simulate(cktQ *toEvaluate, cktQ *notEvaluated, int level, cktList* dFrontier);
+        void buildNetlist();
+        void initSearch();
+        void scheduleFanouts(cktNode* node);
+        void propagate();
+        void assign(cktNode* node, LOGIC v);
+        void undoTrail(int mark);
+        void syncSearch();
+        void updateFrontier(int idx);
         faultSet rflCheckpoint();
         
         inputMap* randomTestGen();
-        bool podem(Fault* fault, cktList* dFrontier);
-        OBJECTIVE objective(cktList* dFrontier);
+        inputMap* PODEM(Fault* fault, int* backtracks);
+        bool podem(Fault* fault, int* backtracks);
+        bool backtrack(vector<DECISION>* decisions, int* backtracks);
+        cktNode* dFrontierGate(int* count);
+        void findHeadlines();
+        bool fan(cktNode* dNode, int* backtracks);
+        void markFaultCone(cktNode* dNode);
+        void markFanCones(cktNode* dNode);
+        bool sensitizeDominators(cktNode* dNode);
+        bool dominatorSideInputs(cktNode* gate, vector<OBJECTIVE>* open);
+        bool addNecessary(cktNode* node, LOGIC v);
+        OBJECTIVE multipleBacktrace();
+        void fanRequest(int idx, LOGIC v, int count, priority_queue<int>* pending, vector<int>* touched);
+        void justifyFree(cktNode* node, LOGIC v);
+        double faultElapsed();
+        OBJECTIVE objective();
         OBJECTIVE backtrace(OBJECTIVE kv);
-        void backwardsImplication(cktNode* root);
+        bool backwardsImplication(cktNode* root);
+        bool learnedImplication(cktNode* root, LOGIC v);
+        bool activated();
+        bool necessaryHolds();
         bool faultAtPO();
+        inputMap* satTest(Fault* fault);
         
-        bool xPathCheck(cktNode* node);
-        bool xPathCheck(cktList* dFrontier);
+        bool xPathCheck();
+        bool xPathCheck(int idx);
         void placeholder();
         void resetPO();
 
+        faultMap* blockFaultSim(faultSet* fl, inputList* inputs, bool traced);
+        void randomFaults(faultSet* faults, faultSet* detected, PatternStore* tests);
+        int randomBlocks(faultSet* faults, faultSet* detected, PatternStore* tests, uint64_t* seed);
+        void targetFaults(faultSet* faults, faultSet* detected, PatternStore* tests);
+        void podemWorker(ATPGWORK* work);
+        void commitResult(ATPGWORK* work, int i);
+        void compactTest(ATPGWORK* work, const vector<Fault*>& local, int i, inputMap* cube);
+        void fillTest(int i, inputMap* test);
+        bool gradeTest(ATPGWORK* work, const vector<Fault*>& local, map<Fault*, int>& indexOf,
+                int i, inputMap* test, vector<int>* detects);
+        inputMap* generateTest(Fault* fault, inputMap* cube, int* backtracks, bool* untestable);
         faultSet collapseFaults(faultSet faults);
         Fault* equivalentFault(cktNode* faultNode, int sav);
 
+        Circuit(Circuit* parent);
+
     public:
         Circuit(char* filename);
+        ~Circuit();
 
         cktNode     getNode(int nodeID);
         void        addFault(Fault* fault);
-        double      atpg(inputSet* testVectors);
-        double      atpg_det(inputSet* testVectors);
+        double      atpg(PatternStore* tests);
+        double      learn();
+        Implications* getImplications() {return implications;};
+        Dominators* getDominators() {return dominators;};
+        Compactor*  getCompactor();
+        void        compactTests(PatternStore* tests);
+        double      atpg_det(PatternStore* tests);
+        void        setLimits(int backtracks, double seconds);
+        void        setOrdered(bool ordered) {this->ordered = ordered;};
+        void        setFan(bool fan) {this->useFan = fan;};
+        const ATPGSTATS& getStats() {return stats;};
         Fault*      createFault(int nodeID, int sav);
         faultMap*   deductiveFaultSim(faultSet* fl, inputList* inputs);
+        faultMap*   criticalPathFaultSim(faultSet* fl, inputList* inputs);
         double      faultCoverage(faultSet* detectedFaults);
         faultSet    generateFaults(bool reduced);
         LOGIC       getNodeLogic(int nodeID);
         vector<int> getNodeIDs();
+        vector<int> getPIs();
         int         getMaxLevels(){return maxLevel;};
         vector<cktNode*> getPINodeList(){return PInodes;};
         vector<cktNode*> getPONodeList(){return POnodes;};
 
         inputList   randomTestsGen(int numTests);
+        inputList   weightedTestsGen(int numTests);
         inputMap*   PODEM(Fault* fault);
         void        printPO();
         void        reset();
         void        simulate(map<int, LOGIC> *input);
+        void        simulateCompiled(inputMap* input);
+        LOGIC       getCompiledValue(int nodeID);
+        CompiledSim* getNativeSim();
 
-        inline cktMap getNodes() {return nodes;};     
+        inline const cktMap& getNodes() {return nodes;};
+        inline Netlist* getNetlist() {return netlist;};     
         inline int getNumPI() {return PInodes.size();};
         inline int getNumPO() {return POnodes.size();};
         inline int getNumNodes() {return nodes.size();};
@@ -0,0 +1,133 @@
+/* Compactor class
+*/
+
+#include "Compactor.h"
+
+Compactor::Compactor(Netlist* netlist, FaultSim* faultSim) {
+    this->netlist = netlist;
+    this->faultSim = faultSim;
+    this->words = 0;
+}
+
+// Indices of the tests to keep, in their original order, such that
+// every fault (netlist index, stuck-at value) any test detects is still
+// detected
+vector<int> Compactor::compact(const PatternStore& tests, const vector<pair<int, int> >& faults) {
+    buildMatrix(tests, faults);
+    vector<int> all(tests.size());
+    for (int t = 0; t < tests.size(); t++) {
+        all[t] = t;
+    }
+    vector<int> keep = setCover(reverseOrder(all));
+    sort(keep.begin(), keep.end());
+    detects.clear();
+    return keep;
+}
+
+// PPSFP over blocks of PPSFP_WIDTH tests; each fault's detection mask is
+// scattered into the rows of the tests that detect it
+void Compactor::buildMatrix(const PatternStore& tests, const vector<pair<int, int> >& faults) {
+    words = (faults.size() + 63) / 64;
+    detects.assign((size_t) tests.size() * words, 0);
+    inputMap test[PPSFP_WIDTH];
+    for (int base = 0; base < tests.size(); base += PPSFP_WIDTH) {
+        faultSim->clearPatterns();
+        for (int b = 0; b < PPSFP_WIDTH && base + b < tests.size(); b++) {
+            tests.getTest(base + b, &test[b]);
+            faultSim->setPattern(b, &test[b]);
+        }
+        faultSim->simulateGood();
+        for (int f = 0; f < faults.size(); f++) {
+            uint64_t mask = faultSim->detect(faults[f].first, faults[f].second);
+            while (mask) {
+                int b = __builtin_ctzll(mask);
+                mask &= mask - 1;
+                row(base + b)[f / 64] |= 1ULL << (f % 64);
+            }
+        }
+    }
+}
+
+// Last test first; a test is kept if it detects a fault the kept tests
+// do not
+vector<int> Compactor::reverseOrder(const vector<int>& tests) {
+    vector<uint64_t> covered(words, 0);
+    vector<int> keep;
+    for (int i = tests.size() - 1; i >= 0; i--) {
+        uint64_t* r = row(tests[i]);
+        bool adds = false;
+        for (int w = 0; w < words; w++) {
+            adds = adds || (r[w] & ~covered[w]);
+            covered[w] |= r[w];
+        }
+        if (adds) {
+            keep.push_back(tests[i]);
+        }
+    }
+    return keep;
+}
+
+// Essential tests, then greedy by the number of faults a test adds. The
+// gains only shrink as faults get covered, so a test is taken once its
+// recomputed gain still tops the queue.
+vector<int> Compactor::setCover(const vector<int>& tests) {
+    // faults detected by exactly one test mark that test essential
+    vector<uint64_t> once(words, 0);
+    vector<uint64_t> twice(words, 0);
+    for (int i = 0; i < tests.size(); i++) {
+        uint64_t* r = row(tests[i]);
+        for (int w = 0; w < words; w++) {
+            twice[w] |= once[w] & r[w];
+            once[w] |= r[w];
+        }
+    }
+
+    vector<uint64_t> covered(words, 0);
+    vector<int> keep;
+    priority_queue<pair<int, int> > gains;     // gain, -position in tests
+    for (int i = 0; i < tests.size(); i++) {
+        uint64_t* r = row(tests[i]);
+        bool essential = false;
+        for (int w = 0; w < words && !essential; w++) {
+            essential = (r[w] & once[w] & ~twice[w]) != 0;
+        }
+        if (essential) {
+            keep.push_back(tests[i]);
+            for (int w = 0; w < words; w++) {
+                covered[w] |= r[w];
+            }
+        }
+    }
+    for (int i = 0; i < tests.size(); i++) {
+        uint64_t* r = row(tests[i]);
+        int gain = 0;
+        for (int w = 0; w < words; w++) {
+            gain += __builtin_popcountll(r[w] & ~covered[w]);
+        }
+        if (gain > 0) {
+            gains.push(make_pair(gain, -i));
+        }
+    }
+
+    while (!gains.empty()) {
+        pair<int, int> top = gains.top();
+        gains.pop();
+        uint64_t* r = row(tests[-top.second]);
+        int gain = 0;
+        for (int w = 0; w < words; w++) {
+            gain += __builtin_popcountll(r[w] & ~covered[w]);
+        }
+        if (gain == 0) {
+            continue;
+        }
+        if (gain < top.first) {
+            gains.push(make_pair(gain, top.second));
+            continue;
+        }
+        keep.push_back(tests[-top.second]);
+        for (int w = 0; w < words; w++) {
+            covered[w] |= r[w];
+        }
+    }
+    return keep;
+}
@@ -0,0 +1,41 @@
+/* header for Compactor class
+   Static test compaction. Every test is fault simulated against every
+   fault without dropping, giving a detection matrix with one bit row
+   over the faults per test. Reverse-order fault simulation then keeps a
+   test only if it detects a fault none of the later tests kept so far
+   detects. The survivors go through a set cover: tests that are the
+   only ones to detect some fault are taken first, then greedily the
+   test adding the most undetected faults. All steps work a word of
+   faults at a time.
+*/
+#ifndef COMPACTOR_H
+#define COMPACTOR_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+#include "FaultSim.h"
+#include "PatternStore.h"
+
+class Compactor {
+    private:
+        Netlist* netlist;
+        FaultSim* faultSim;
+        int words;                      // words per row
+        vector<uint64_t> detects;       // row per test, bit per fault
+
+        inline uint64_t* row(int test) {return &detects[(size_t) test * words];};
+        void buildMatrix(const PatternStore& tests, const vector<pair<int, int> >& faults);
+        vector<int> reverseOrder(const vector<int>& tests);
+        vector<int> setCover(const vector<int>& tests);
+
+    public:
+        Compactor(Netlist* netlist, FaultSim* faultSim);
+
+        inline Netlist* getNetlist() {return netlist;};
+
+        vector<int> compact(const PatternStore& tests, const vector<pair<int, int> >& faults);
+};
+
+#include "Compactor.cpp"
+#endif
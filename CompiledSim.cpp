@@ -0,0 +1,242 @@
+/* CompiledSim class
+*/
+
+#include "CompiledSim.h"
+
+CompiledSim::CompiledSim(Netlist* nl, string name) {
+    netlist = nl;
+    cktName = name;
+    handle = NULL;
+    kernel = NULL;
+    ones.assign(netlist->getNumNodes(), 0);
+    zeros.assign(netlist->getNumNodes(), 0);
+}
+
+CompiledSim::~CompiledSim() {
+    if (handle != NULL) {
+        dlclose(handle);
+    }
+}
+
+// FNV-1a over everything the generated code depends on
+uint64_t CompiledSim::hashNetlist() {
+    uint64_t hash = 14695981039346656037ULL;
+    vector<int> words;
+    words.push_back(SIMKERNEL_ABI);
+    words.push_back(netlist->getNumNodes());
+    for (int i = 0; i < netlist->getNumNodes(); i++) {
+        words.push_back(netlist->getGateType(i));
+        words.push_back(netlist->getNodeType(i));
+        words.push_back(netlist->getNumFanIns(i));
+        const int* fanins = netlist->getFanIns(i);
+        for (int j = 0; j < netlist->getNumFanIns(i); j++) {
+            words.push_back(fanins[j]);
+        }
+    }
+    for (int i = 0; i < words.size(); i++) {
+        uint32_t w = words[i];
+        for (int b = 0; b < 4; b++) {
+            hash ^= (w >> (8 * b)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+bool CompiledSim::writeSource(const char* srcFile) {
+    FILE* fptr = fopen(srcFile, "w");
+    if (fptr == NULL) {
+        return false;
+    }
+
+    fprintf(fptr, "// generated simulation kernel for %s, do not edit\n", cktName.c_str());
+    fprintf(fptr, "#include <stdint.h>\n\n");
+    fprintf(fptr, "extern \"C\" void sim_kernel(uint64_t* __restrict ones, uint64_t* __restrict zeros) {\n");
+
+    for (int i = 0; i < netlist->getNumNodes(); i++) {
+        int nIn = netlist->getNumFanIns(i);
+        const int* in = netlist->getFanIns(i);
+        gateT gate = netlist->getGateType(i);
+
+        if (netlist->getNodeType(i) == PI || nIn == 0) {
+            fprintf(fptr, "    const uint64_t o%d = ones[%d], z%d = zeros[%d];\n", i, i, i, i);
+            continue;
+        }
+
+        // ov/zv name the rails the gate function is written into; an
+        // inverting gate simply writes them swapped.
+        bool invert = (gate == NAND || gate == NOR || gate == XNOR || gate == NOT);
+        char ov = invert ? 'z' : 'o';
+        char zv = invert ? 'o' : 'z';
+
+        switch (gate) {
+            case AND:
+            case NAND:
+            case OR:
+            case NOR: {
+                bool isAnd = (gate == AND || gate == NAND);
+                fprintf(fptr, "    const uint64_t %c%d = o%d", ov, i, in[0]);
+                for (int j = 1; j < nIn; j++) {
+                    fprintf(fptr, " %c o%d", isAnd ? '&' : '|', in[j]);
+                }
+                fprintf(fptr, ", %c%d = z%d", zv, i, in[0]);
+                for (int j = 1; j < nIn; j++) {
+                    fprintf(fptr, " %c z%d", isAnd ? '|' : '&', in[j]);
+                }
+                fprintf(fptr, ";\n");
+                break;
+            }
+            case XOR:
+            case XNOR:
+                fprintf(fptr, "    uint64_t %c%d = o%d, %c%d = z%d;\n", ov, i, in[0], zv, i, in[0]);
+                for (int j = 1; j < nIn; j++) {
+                    fprintf(fptr, "    { const uint64_t t = (%c%d & z%d) | (%c%d & o%d);"
+                            " %c%d = (%c%d & o%d) | (%c%d & z%d); %c%d = t; }\n",
+                            ov, i, in[j], zv, i, in[j],
+                            zv, i, ov, i, in[j], zv, i, in[j], ov, i);
+                }
+                break;
+            default:    // BRCH, NOT and single input buffers
+                fprintf(fptr, "    const uint64_t %c%d = o%d, %c%d = z%d;\n", ov, i, in[0], zv, i, in[0]);
+                break;
+        }
+        fprintf(fptr, "    ones[%d] = o%d; zeros[%d] = z%d;\n", i, i, i, i);
+    }
+    fprintf(fptr, "}\n");
+    fclose(fptr);
+    return true;
+}
+
+// Loads the cached kernel for this netlist, generating and compiling it
+// first if needed. Returns false if the interpreter will be used instead.
+// ATPG workers may load at the same time and share the cache files, so
+// one kernel is built at a time.
+bool CompiledSim::load() {
+    static mutex building;
+    lock_guard<mutex> guard(building);
+    if (kernel != NULL) {
+        return true;
+    }
+
+    char base[MAXLINE * 2];
+    char srcFile[MAXLINE * 2];
+    char soFile[MAXLINE * 2];
+    char tmpFile[MAXLINE * 2];
+    char cmd[MAXLINE * 8];
+    sprintf(base, "%s/%s_%016llx", SIMCACHE_DIR, cktName.c_str(), (unsigned long long) hashNetlist());
+    sprintf(srcFile, "%s.cpp", base);
+    sprintf(soFile, "%s.so", base);
+    sprintf(tmpFile, "%s.%d.so", base, (int) getpid());
+
+    struct stat st;
+    if (stat(soFile, &st) != 0) {
+        mkdir(SIMCACHE_DIR, 0755);
+        if (!writeSource(srcFile)) {
+            printf("Cannot write %s; using interpreted simulation\n", srcFile);
+            return false;
+        }
+        sprintf(cmd, "g++ -O1 -shared -fPIC -o %s %s > /dev/null 2>&1", tmpFile, srcFile);
+        if (system(cmd) != 0 || rename(tmpFile, soFile) != 0) {
+            printf("Cannot compile %s; using interpreted simulation\n", srcFile);
+            remove(tmpFile);
+            return false;
+        }
+    }
+
+    // dlopen needs a path, not a bare file name
+    char soPath[MAXLINE * 2 + 2];
+    sprintf(soPath, "./%s", soFile);
+    handle = dlopen(soPath, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        printf("Cannot load %s: %s; using interpreted simulation\n", soFile, dlerror());
+        return false;
+    }
+    kernel = (simKernel) dlsym(handle, "sim_kernel");
+    if (kernel == NULL) {
+        dlclose(handle);
+        handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+void CompiledSim::clearInputs() {
+    const vector<int>& PIs = netlist->getPIs();
+    for (int i = 0; i < PIs.size(); i++) {
+        ones[PIs[i]] = 0;
+        zeros[PIs[i]] = 0;
+    }
+}
+
+void CompiledSim::setInput(int idx, int bit, LOGIC v) {
+    uint64_t mask = 1ULL << bit;
+    ones[idx] &= ~mask;
+    zeros[idx] &= ~mask;
+    if (v == ONE) {
+        ones[idx] |= mask;
+    } else if (v == ZERO) {
+        zeros[idx] |= mask;
+    }
+}
+
+LOGIC CompiledSim::getValue(int idx, int bit) {
+    if ((ones[idx] >> bit) & 1ULL) {return ONE;}
+    if ((zeros[idx] >> bit) & 1ULL) {return ZERO;}
+    return X;
+}
+
+void CompiledSim::run() {
+    if (kernel != NULL) {
+        kernel(ones.data(), zeros.data());
+    } else {
+        interpret();
+    }
+}
+
+// Fallback with the same semantics as the generated code
+void CompiledSim::interpret() {
+    uint64_t* o = ones.data();
+    uint64_t* z = zeros.data();
+
+    for (int i = 0; i < netlist->getNumNodes(); i++) {
+        int nIn = netlist->getNumFanIns(i);
+        if (netlist->getNodeType(i) == PI || nIn == 0) {
+            continue;
+        }
+        const int* in = netlist->getFanIns(i);
+        gateT gate = netlist->getGateType(i);
+        uint64_t ov = o[in[0]];
+        uint64_t zv = z[in[0]];
+
+        for (int j = 1; j < nIn; j++) {
+            switch (gate) {
+                case AND:
+                case NAND:
+                    ov &= o[in[j]];
+                    zv |= z[in[j]];
+                    break;
+                case OR:
+                case NOR:
+                    ov |= o[in[j]];
+                    zv &= z[in[j]];
+                    break;
+                case XOR:
+                case XNOR: {
+                    uint64_t t = (ov & z[in[j]]) | (zv & o[in[j]]);
+                    zv = (ov & o[in[j]]) | (zv & z[in[j]]);
+                    ov = t;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        if (gate == NAND || gate == NOR || gate == XNOR || gate == NOT) {
+            o[i] = zv;
+            z[i] = ov;
+        } else {
+            o[i] = ov;
+            z[i] = zv;
+        }
+    }
+}
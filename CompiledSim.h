@@ -0,0 +1,57 @@
+/* header for CompiledSim class
+   Native, per-circuit simulation kernel. A C++ source file with one
+   statement per gate is generated from the Netlist, compiled into a
+   shared object with the local g++ and loaded with dlopen(). Values are
+   dual-rail 64-bit words (bit set in ones = 1, bit set in zeros = 0,
+   neither = X), so each call simulates 64 patterns. The shared object is
+   cached under SIMCACHE_DIR keyed by a hash of the netlist. When no
+   compiler is available the same word-level evaluation is interpreted.
+*/
+#ifndef COMPILEDSIM_H
+#define COMPILEDSIM_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define SIMCACHE_DIR ".simcache"
+#define SIMKERNEL_ABI 1
+
+typedef void (*simKernel)(uint64_t* ones, uint64_t* zeros);
+
+class CompiledSim {
+    private:
+        Netlist* netlist;
+        string cktName;
+        void* handle;
+        simKernel kernel;
+
+        vector<uint64_t> ones;
+        vector<uint64_t> zeros;
+
+        uint64_t hashNetlist();
+        bool writeSource(const char* srcFile);
+        void interpret();
+
+    public:
+        CompiledSim(Netlist* netlist, string cktName);
+        ~CompiledSim();
+
+        bool        load();
+        inline bool isNative() {return kernel != NULL;};
+
+        void        clearInputs();
+        void        setInput(int idx, int bit, LOGIC v);
+        inline void setInputWord(int idx, uint64_t o, uint64_t z) {ones[idx] = o; zeros[idx] = z;};
+        LOGIC       getValue(int idx, int bit);
+        inline uint64_t getOnes(int idx) {return ones[idx];};
+        inline uint64_t getZeros(int idx) {return zeros[idx];};
+        void        run();
+};
+
+#include "CompiledSim.cpp"
+#endif
@@ -0,0 +1,179 @@
+/* Cop class
+*/
+
+#include "Cop.h"
+
+Cop::Cop(Netlist* netlist) {
+    this->netlist = netlist;
+    setUniform();
+}
+
+void Cop::setUniform() {
+    weight.assign(netlist->getNumNodes(), COP_STEPS / 2);
+    controllability();
+    observability();
+}
+
+void Cop::controllability() {
+    p1.assign(netlist->getNumNodes(), 0.5);
+    for (int idx = 0; idx < netlist->getNumNodes(); idx++) {
+        p1[idx] = gateP1(idx);
+    }
+}
+
+void Cop::observability() {
+    obs.assign(netlist->getNumNodes(), 0);
+    for (int idx = netlist->getNumNodes() - 1; idx >= 0; idx--) {
+        obs[idx] = nodeObs(idx);
+    }
+}
+
+// P1 of idx from the P1 of its fanins
+double Cop::gateP1(int idx) {
+    int nIn = netlist->getNumFanIns(idx);
+    const int* in = netlist->getFanIns(idx);
+    if (nIn == 0) {
+        return (double) weight[idx] / COP_STEPS;
+    }
+
+    double p = p1[in[0]];
+    gateT gate = netlist->getGateType(idx);
+    for (int j = 1; j < nIn; j++) {
+        double q = p1[in[j]];
+        switch (gate) {
+            case AND:
+            case NAND:
+                p *= q;
+                break;
+            case OR:
+            case NOR:
+                p = 1 - (1 - p) * (1 - q);
+                break;
+            case XOR:
+            case XNOR:
+                p = p * (1 - q) + q * (1 - p);
+                break;
+            default:
+                break;
+        }
+    }
+    if (gate == NAND || gate == NOR || gate == XNOR || gate == NOT) {
+        p = 1 - p;
+    }
+    return p;
+}
+
+// OBS of idx from the OBS of its fanouts and the P1 of their other
+// inputs, taking the best branch as SCOAP does
+double Cop::nodeObs(int idx) {
+    double best = (netlist->getNodeType(idx) == PO) ? 1 : 0;
+    const int* fanouts = netlist->getFanOuts(idx);
+    for (int i = 0; i < netlist->getNumFanOuts(idx); i++) {
+        int fo = fanouts[i];
+        gateT gate = netlist->getGateType(fo);
+        double o = obs[fo];
+        netlist->forSideInputs(fo, idx, [&](int in) {
+            if (gate == AND || gate == NAND) {
+                o *= p1[in];
+            } else if (gate == OR || gate == NOR) {
+                o *= 1 - p1[in];
+            }
+        });
+        best = max(best, o);
+    }
+    return best;
+}
+
+// Expected number of the faults detected by the given number of patterns
+double Cop::score(const vector<pair<int, int> >& faults, int patterns) {
+    double s = 0;
+    for (int f = 0; f < faults.size(); f++) {
+        double d = min(detectProb(faults[f].first, faults[f].second), 1.0);
+        s -= expm1(patterns * log1p(-d));
+    }
+    return s;
+}
+
+// The nodes the score depends on: fanout holds the fanout cones of the
+// fault sites, last node first, and fanin everything in the fanin of
+// those cones, first node first
+void Cop::cones(const vector<pair<int, int> >& faults, vector<int>* fanin, vector<int>* fanout) {
+    int numNodes = netlist->getNumNodes();
+    vector<char> cone(numNodes, 0);
+    for (int f = 0; f < faults.size(); f++) {
+        cone[faults[f].first] = 1;
+    }
+    for (int idx = 0; idx < numNodes; idx++) {
+        const int* in = netlist->getFanIns(idx);
+        for (int j = 0; j < netlist->getNumFanIns(idx) && !cone[idx]; j++) {
+            cone[idx] = cone[in[j]];
+        }
+    }
+    fanout->clear();
+    for (int idx = numNodes - 1; idx >= 0; idx--) {
+        if (cone[idx]) {
+            fanout->push_back(idx);
+        }
+    }
+    for (int idx = numNodes - 1; idx >= 0; idx--) {
+        const int* fanouts = netlist->getFanOuts(idx);
+        for (int i = 0; i < netlist->getNumFanOuts(idx) && !cone[idx]; i++) {
+            cone[idx] = cone[fanouts[i]];
+        }
+    }
+    fanin->clear();
+    for (int idx = 0; idx < numNodes; idx++) {
+        if (cone[idx]) {
+            fanin->push_back(idx);
+        }
+    }
+}
+
+// Weights under which the given number of patterns is expected to detect
+// the most of faults. Coordinate search over the PIs in the fanin cones,
+// starting from 1/2: each PI in turn takes the candidate weight that most
+// improves the score, until a sweep changes nothing or after COP_SWEEPS.
+// A candidate is scored by re-evaluating the cones only.
+void Cop::optimize(const vector<pair<int, int> >& faults, int patterns) {
+    static const int candidates[] = {4, 6, 8, 10, 12};
+    vector<int> fanin, fanout;
+    cones(faults, &fanin, &fanout);
+    setUniform();
+    double best = score(faults, patterns);
+
+    for (int sweep = 0; sweep < COP_SWEEPS; sweep++) {
+        bool changed = false;
+        for (int i = 0; i < fanin.size(); i++) {
+            int pi = fanin[i];
+            if (netlist->getNumFanIns(pi) != 0) {
+                continue;
+            }
+            int start = weight[pi];
+            int bestWeight = start;
+            for (int c = 0; c < sizeof(candidates) / sizeof(int); c++) {
+                if (candidates[c] == start) {
+                    continue;
+                }
+                weight[pi] = candidates[c];
+                for (int k = 0; k < fanin.size(); k++) {
+                    p1[fanin[k]] = gateP1(fanin[k]);
+                }
+                for (int k = 0; k < fanout.size(); k++) {
+                    obs[fanout[k]] = nodeObs(fanout[k]);
+                }
+                double s = score(faults, patterns);
+                if (s > best) {
+                    best = s;
+                    bestWeight = candidates[c];
+                }
+            }
+            changed = changed || (bestWeight != start);
+            weight[pi] = bestWeight;
+        }
+        controllability();
+        observability();
+        if (!changed) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+/* header for Cop class
+   COP testability measures over the levelized netlist: P1 is the
+   probability that a node is 1 under random patterns with a given 1
+   probability (weight) on each PI, and OBS the probability that a
+   change at the node reaches a PO. A stuck-at fault is then detected
+   by one pattern with probability P(node = !sav) * OBS. Weights are
+   multiples of 1/COP_STEPS so patterns can be drawn from whole random
+   words (see weightedWord); optimize() picks them to maximize the
+   expected number of faults a test of given length detects.
+*/
+#ifndef COP_H
+#define COP_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+
+#define COP_STEPS 16            // weight resolution
+#define COP_SWEEPS 2            // passes over the PIs in optimize()
+
+class Cop {
+    private:
+        Netlist* netlist;
+        vector<int> weight;             // per node; only PIs are used
+        vector<double> p1;
+        vector<double> obs;
+
+        void controllability();
+        void observability();
+        double gateP1(int idx);
+        double nodeObs(int idx);
+        void cones(const vector<pair<int, int> >& faults, vector<int>* fanin, vector<int>* fanout);
+        double score(const vector<pair<int, int> >& faults, int patterns);
+
+    public:
+        Cop(Netlist* netlist);
+
+        void    setUniform();
+        void    optimize(const vector<pair<int, int> >& faults, int patterns);
+        inline int getWeight(int idx) const {return weight[idx];};
+        inline double getP1(int idx) const {return p1[idx];};
+        inline double getObs(int idx) const {return obs[idx];};
+        inline double detectProb(int idx, int sav) const {return (sav ? 1 - p1[idx] : p1[idx]) * obs[idx];};
+};
+
+#include "Cop.cpp"
+#endif
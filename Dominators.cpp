@@ -0,0 +1,43 @@
+/* Dominators class
+*/
+
+#include "Dominators.h"
+
+Dominators::Dominators(Netlist* netlist) {
+    this->netlist = netlist;
+    int numNodes = netlist->getNumNodes();
+    idom.assign(numNodes, DOM_ROOT);
+    depth.assign(numNodes, 1);
+
+    // fanouts have higher indices, so they are done before their fanins
+    for (int idx = numNodes - 1; idx >= 0; idx--) {
+        int nOut = netlist->getNumFanOuts(idx);
+        if (netlist->getNodeType(idx) == PO || nOut == 0) {
+            continue;
+        }
+        const int* out = netlist->getFanOuts(idx);
+        int d = out[0];
+        for (int j = 1; j < nOut && d != DOM_ROOT; j++) {
+            d = intersect(d, out[j]);
+        }
+        idom[idx] = d;
+        depth[idx] = depthOf(d) + 1;
+    }
+}
+
+// Nearest common dominator of a and b
+int Dominators::intersect(int a, int b) const {
+    while (a != b) {
+        while (depthOf(a) > depthOf(b)) {
+            a = idom[a];
+        }
+        while (depthOf(b) > depthOf(a)) {
+            b = idom[b];
+        }
+        if (a != b) {
+            a = idom[a];
+            b = idom[b];
+        }
+    }
+    return a;
+}
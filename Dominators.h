@@ -0,0 +1,36 @@
+/* header for Dominators class
+   PO-dominator tree of the netlist. Node d dominates node n when every
+   path from n to a PO passes through d, so a fault effect at n can only
+   be observed through d and the side inputs of d must hold their
+   non-controlling value in every test. The root of the tree is a
+   virtual sink fed by all POs; getIdom() returns DOM_ROOT for nodes
+   dominated by nothing else. Built in one pass from the POs back, since
+   index order is a topological order.
+*/
+#ifndef DOMINATORS_H
+#define DOMINATORS_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+
+#define DOM_ROOT -1
+
+class Dominators {
+    private:
+        Netlist* netlist;
+        vector<int> idom;               // immediate dominator
+        vector<int> depth;              // distance from the sink
+
+        inline int depthOf(int idx) const {return idx == DOM_ROOT ? 0 : depth[idx];};
+        int intersect(int a, int b) const;
+
+    public:
+        Dominators(Netlist* netlist);
+
+        inline Netlist* getNetlist() {return netlist;};
+        inline int getIdom(int idx) const {return idom[idx];};
+};
+
+#include "Dominators.cpp"
+#endif
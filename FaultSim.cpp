@@ -0,0 +1,236 @@
+/* FaultSim class
+*/
+
+#include "FaultSim.h"
+
+// The good machine runs on the circuit's generated kernel when it can be
+// built, and on the interpreter otherwise
+FaultSim::FaultSim(Netlist* nl, string cktName) : good(nl, cktName) {
+    good.load();
+    netlist = nl;
+    validMask = 0;
+    currStamp = 0;
+    faultyOnes.assign(netlist->getNumNodes(), 0);
+    faultyZeros.assign(netlist->getNumNodes(), 0);
+    stamp.assign(netlist->getNumNodes(), 0);
+    critical.assign(netlist->getNumNodes(), 0);
+    queued.assign(netlist->getNumNodes(), 0);
+    eventQueue.assign(netlist->getMaxLevel() + 1, vector<int>());
+}
+
+void FaultSim::clearPatterns() {
+    good.clearInputs();
+    validMask = 0;
+}
+
+void FaultSim::setPattern(int bit, inputMap* input) {
+    for (inputMap::iterator it = input->begin(); it != input->end(); ++it) {
+        good.setInput(netlist->getIndex(it->first), bit, it->second);
+    }
+    validMask |= 1ULL << bit;
+}
+
+// Binary values of one PI across all PPSFP_WIDTH patterns
+void FaultSim::setPatternWord(int piIdx, uint64_t ones) {
+    good.setInputWord(piIdx, ones, ~ones);
+    validMask = ~0ULL;
+}
+
+void FaultSim::simulateGood() {
+    good.run();
+}
+
+// Dual-rail evaluation of one gate over the current (faulty if touched,
+// good otherwise) fanin values
+void FaultSim::evaluate(int idx, uint64_t &ones, uint64_t &zeros) {
+    int nIn = netlist->getNumFanIns(idx);
+    const int* in = netlist->getFanIns(idx);
+    gateT gate = netlist->getGateType(idx);
+    uint64_t ov = onesOf(in[0]);
+    uint64_t zv = zerosOf(in[0]);
+
+    for (int j = 1; j < nIn; j++) {
+        uint64_t oj = onesOf(in[j]);
+        uint64_t zj = zerosOf(in[j]);
+        switch (gate) {
+            case AND:
+            case NAND:
+                ov &= oj;
+                zv |= zj;
+                break;
+            case OR:
+            case NOR:
+                ov |= oj;
+                zv &= zj;
+                break;
+            case XOR:
+            case XNOR: {
+                uint64_t t = (ov & zj) | (zv & oj);
+                zv = (ov & oj) | (zv & zj);
+                ov = t;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    if (gate == NAND || gate == NOR || gate == XNOR || gate == NOT) {
+        ones = zv;
+        zeros = ov;
+    } else {
+        ones = ov;
+        zeros = zv;
+    }
+}
+
+// Injects nodeIdx stuck-at sav into the current patterns and returns the
+// patterns (as a bit mask) that show a binary difference at some PO.
+uint64_t FaultSim::detect(int nodeIdx, int sav) {
+    // only patterns where the good value is the opposite binary value
+    // activate the fault
+    uint64_t active = (sav ? good.getZeros(nodeIdx) : good.getOnes(nodeIdx)) & validMask;
+    if (!active) {
+        return 0;
+    }
+    return propagate(nodeIdx, sav ? ~0ULL : 0ULL, sav ? 0ULL : ~0ULL);
+}
+
+// Forces nodeIdx to the given words and propagates the difference to the
+// POs. Returns the patterns with a binary difference at some PO.
+uint64_t FaultSim::propagate(int nodeIdx, uint64_t siteOnes, uint64_t siteZeros) {
+    currStamp++;
+    stamp[nodeIdx] = currStamp;
+    faultyOnes[nodeIdx] = siteOnes;
+    faultyZeros[nodeIdx] = siteZeros;
+
+    int maxLevel = netlist->getMaxLevel();
+    int minLevel = maxLevel + 1;
+    uint64_t detected = 0;
+    int idx = nodeIdx;
+
+    while (true) {
+        if (netlist->getNodeType(idx) == PO) {
+            detected |= (good.getOnes(idx) & faultyZeros[idx]) | (good.getZeros(idx) & faultyOnes[idx]);
+        }
+        const int* fanouts = netlist->getFanOuts(idx);
+        for (int i = 0; i < netlist->getNumFanOuts(idx); i++) {
+            int fo = fanouts[i];
+            if (!queued[fo]) {
+                queued[fo] = 1;
+                eventQueue[netlist->getLevel(fo)].push_back(fo);
+                minLevel = min(minLevel, netlist->getLevel(fo));
+            }
+        }
+
+        // next node whose faulty value differs from the good value
+        idx = -1;
+        while (idx < 0 && minLevel <= maxLevel) {
+            vector<int>& bucket = eventQueue[minLevel];
+            if (bucket.empty()) {
+                minLevel++;
+                continue;
+            }
+            int next = bucket.back();
+            bucket.pop_back();
+            queued[next] = 0;
+
+            uint64_t ones, zeros;
+            evaluate(next, ones, zeros);
+            if (ones != good.getOnes(next) || zeros != good.getZeros(next)) {
+                stamp[next] = currStamp;
+                faultyOnes[next] = ones;
+                faultyZeros[next] = zeros;
+                idx = next;
+            }
+        }
+        if (idx < 0) {
+            break;
+        }
+    }
+
+    return detected & validMask;
+}
+
+// Patterns in which flipping input pin of gate idx alone flips the gate output
+uint64_t FaultSim::sensitivity(int idx, int pin) {
+    int nIn = netlist->getNumFanIns(idx);
+    const int* in = netlist->getFanIns(idx);
+    uint64_t sens = good.getOnes(in[pin]) | good.getZeros(in[pin]);
+
+    switch (netlist->getGateType(idx)) {
+        case AND:
+        case NAND:
+            // every other input at the non-controlling value 1
+            for (int j = 0; j < nIn; j++) {
+                if (j != pin) {sens &= good.getOnes(in[j]);}
+            }
+            break;
+        case OR:
+        case NOR:
+            for (int j = 0; j < nIn; j++) {
+                if (j != pin) {sens &= good.getZeros(in[j]);}
+            }
+            break;
+        case XOR:
+        case XNOR:
+            for (int j = 0; j < nIn; j++) {
+                sens &= good.getOnes(in[j]) | good.getZeros(in[j]);
+            }
+            break;
+        case BRCH:
+        case NOT:
+            break;
+        default:
+            if (nIn != 1) {sens = 0;}
+            break;
+    }
+    return sens;
+}
+
+// Critical path tracing over the current patterns. Nodes are visited in
+// reverse level order. Inside a fanout-free region a node is critical
+// where its only fanout is critical and sensitive to it. A stem (more
+// than one fanout) can reconverge, so its criticality comes from
+// simulating the stem flipped in all patterns at once.
+// Only nodes flagged in live, and the fanout-free paths from them up to
+// and including their stems, are traced; all others are left at 0.
+void FaultSim::tracePaths(const vector<char>& live) {
+    int numNodes = netlist->getNumNodes();
+    needed.assign(live.begin(), live.end());
+    for (int idx = 0; idx < numNodes; idx++) {
+        if (needed[idx] && netlist->getNumFanOuts(idx) == 1) {
+            needed[netlist->getFanOuts(idx)[0]] = 1;
+        }
+    }
+
+    for (int idx = numNodes - 1; idx >= 0; idx--) {
+        critical[idx] = 0;
+        if (!needed[idx]) {
+            continue;
+        }
+        uint64_t binary = (good.getOnes(idx) | good.getZeros(idx)) & validMask;
+        int nFo = netlist->getNumFanOuts(idx);
+        uint64_t crit = 0;
+
+        if (nFo > 1) {
+            crit = propagate(idx, good.getZeros(idx), good.getOnes(idx));
+        } else {
+            if (netlist->getNodeType(idx) == PO) {
+                crit = binary;
+            }
+            if (nFo == 1) {
+                int fo = netlist->getFanOuts(idx)[0];
+                const int* in = netlist->getFanIns(fo);
+                int pin = 0;
+                while (in[pin] != idx) {pin++;}
+                crit |= critical[fo] & sensitivity(fo, pin);
+            }
+        }
+        critical[idx] = crit & binary;
+    }
+}
+
+// Patterns detecting nodeIdx stuck-at sav, after tracePaths()
+uint64_t FaultSim::detectTraced(int nodeIdx, int sav) {
+    return critical[nodeIdx] & (sav ? good.getZeros(nodeIdx) : good.getOnes(nodeIdx));
+}
@@ -0,0 +1,56 @@
+/* header for FaultSim class
+   Pattern-parallel single-fault propagation (PPSFP). The good machine
+   is simulated for up to 64 patterns at once as dual-rail words; each
+   fault is then injected on its own and the difference is propagated
+   event-driven through the fanout cone only, stopping wherever the
+   faulty value falls back to the good value.
+   Alternatively tracePaths() finds, for all nodes in one backward pass,
+   the patterns in which a flip of the node is observed at a PO; every
+   stuck-at fault is then read off with detectTraced().
+*/
+#ifndef FAULTSIM_H
+#define FAULTSIM_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+#include "CompiledSim.h"
+
+#define PPSFP_WIDTH 64
+
+class FaultSim {
+    private:
+        Netlist* netlist;
+        CompiledSim good;               // word-level good machine, native if possible
+        uint64_t validMask;             // bits holding a pattern
+
+        vector<uint64_t> faultyOnes;    // faulty machine, valid where stamp == currStamp
+        vector<uint64_t> faultyZeros;
+        vector<int> stamp;
+        int currStamp;
+        vector<vector<int> > eventQueue;
+        vector<char> queued;
+        vector<uint64_t> critical;      // patterns in which a flip reaches a PO
+        vector<char> needed;            // nodes tracePaths has to visit
+
+        void evaluate(int idx, uint64_t &ones, uint64_t &zeros);
+        uint64_t propagate(int nodeIdx, uint64_t siteOnes, uint64_t siteZeros);
+        uint64_t sensitivity(int idx, int pin);
+        inline uint64_t onesOf(int idx) {return stamp[idx] == currStamp ? faultyOnes[idx] : good.getOnes(idx);};
+        inline uint64_t zerosOf(int idx) {return stamp[idx] == currStamp ? faultyZeros[idx] : good.getZeros(idx);};
+
+    public:
+        FaultSim(Netlist* netlist, string cktName);
+
+        void        clearPatterns();
+        void        setPattern(int bit, inputMap* input);
+        void        setPatternWord(int piIdx, uint64_t ones);
+        void        simulateGood();
+        uint64_t    detect(int nodeIdx, int sav);
+        void        tracePaths(const vector<char>& live);
+        uint64_t    detectTraced(int nodeIdx, int sav);
+        inline LOGIC getGoodValue(int idx, int bit) {return good.getValue(idx, bit);};
+};
+
+#include "FaultSim.cpp"
+#endif
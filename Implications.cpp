@@ -0,0 +1,198 @@
+/* Implications class
+*/
+
+#include "Implications.h"
+
+Implications::Implications(Netlist* nl) {
+    netlist = nl;
+    int numNodes = netlist->getNumNodes();
+    values.assign(numNodes, LEARN_X);
+    vector<vector<int> > learned(2 * numNodes);
+
+    for (int idx = 0; idx < numNodes; idx++) {
+        for (char v = 0; v < 2; v++) {
+            // an assignment that conflicts on its own teaches nothing here
+            if (assign(idx, v) && implyAll()) {
+                for (int i = 0; i < assigned.size(); i++) {
+                    int m = assigned[i];
+                    char notW = 1 - values[m];
+                    if (netlist->getLevel(m) > netlist->getLevel(idx) && learnable(m, notW)) {
+                        learned[2 * m + notW].push_back(2 * idx + (1 - v));
+                    }
+                }
+            }
+            clearValues();
+        }
+    }
+
+    litStart.push_back(0);
+    for (int lit = 0; lit < learned.size(); lit++) {
+        lits.insert(lits.end(), learned[lit].begin(), learned[lit].end());
+        litStart.push_back(lits.size());
+    }
+}
+
+// Sets idx to v; false if it already holds the other value
+bool Implications::assign(int idx, char v) {
+    if (values[idx] != LEARN_X) {
+        return values[idx] == v;
+    }
+    values[idx] = v;
+    assigned.push_back(idx);
+    pending.push_back(idx);
+    return true;
+}
+
+void Implications::clearValues() {
+    for (int i = 0; i < assigned.size(); i++) {
+        values[assigned[i]] = LEARN_X;
+    }
+    assigned.clear();
+    pending.clear();
+}
+
+// Direct implications of every pending assignment, to a fixed point
+bool Implications::implyAll() {
+    while (!pending.empty()) {
+        int idx = pending.back();
+        pending.pop_back();
+        if (!backward(idx)) {
+            return false;
+        }
+        const int* fanouts = netlist->getFanOuts(idx);
+        for (int i = 0; i < netlist->getNumFanOuts(idx); i++) {
+            if (!forward(fanouts[i]) || !backward(fanouts[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Evaluates gate idx from its fanins
+bool Implications::forward(int idx) {
+    int nIn = netlist->getNumFanIns(idx);
+    const int* in = netlist->getFanIns(idx);
+    gateT gate = netlist->getGateType(idx);
+    char out;
+
+    switch (gate) {
+        case AND:
+        case NAND:
+        case OR:
+        case NOR: {
+            char ctrl = (gate == AND || gate == NAND) ? 0 : 1;
+            bool hasX = false;
+            out = 1 - ctrl;
+            for (int j = 0; j < nIn; j++) {
+                if (values[in[j]] == ctrl) {
+                    out = ctrl;
+                    break;
+                }
+                hasX |= values[in[j]] == LEARN_X;
+            }
+            if (out != ctrl && hasX) {
+                return true;
+            }
+            break;
+        }
+        case XOR:
+        case XNOR:
+            out = 0;
+            for (int j = 0; j < nIn; j++) {
+                if (values[in[j]] == LEARN_X) {
+                    return true;
+                }
+                out ^= values[in[j]];
+            }
+            break;
+        default:
+            out = values[in[0]];
+            if (out == LEARN_X) {
+                return true;
+            }
+            break;
+    }
+    if (gate == NAND || gate == NOR || gate == XNOR || gate == NOT) {
+        out = 1 - out;
+    }
+    return assign(idx, out);
+}
+
+// Implies fanins of gate idx from its output value and known fanins
+bool Implications::backward(int idx) {
+    int nIn = netlist->getNumFanIns(idx);
+    if (nIn == 0 || values[idx] == LEARN_X) {
+        return true;
+    }
+    const int* in = netlist->getFanIns(idx);
+    gateT gate = netlist->getGateType(idx);
+    char out = values[idx];
+    if (gate == NAND || gate == NOR || gate == XNOR || gate == NOT) {
+        out = 1 - out;
+    }
+
+    int lastX = -1;
+    int numX = 0;
+    switch (gate) {
+        case AND:
+        case NAND:
+        case OR:
+        case NOR: {
+            char ctrl = (gate == AND || gate == NAND) ? 0 : 1;
+            if (out != ctrl) {
+                // non-controlled output: every fanin is non-controlling
+                for (int j = 0; j < nIn; j++) {
+                    if (!assign(in[j], 1 - ctrl)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            for (int j = 0; j < nIn; j++) {
+                if (values[in[j]] == ctrl) {
+                    return true;
+                }
+                if (values[in[j]] == LEARN_X) {
+                    lastX = in[j];
+                    numX++;
+                }
+            }
+            // the only fanin left has to be the controlling one
+            return numX != 1 || assign(lastX, ctrl);
+        }
+        case XOR:
+        case XNOR:
+            for (int j = 0; j < nIn; j++) {
+                if (values[in[j]] == LEARN_X) {
+                    lastX = in[j];
+                    numX++;
+                } else {
+                    out ^= values[in[j]];
+                }
+            }
+            return numX != 1 || assign(lastX, out);
+        default:
+            return assign(in[0], out);
+    }
+}
+
+// True when idx = v does not fix the fanins of its gate on its own
+bool Implications::learnable(int idx, char v) {
+    if (netlist->getNumFanIns(idx) < 2) {
+        return false;
+    }
+    switch (netlist->getGateType(idx)) {
+        case AND:
+        case NOR:
+            return v == 0;
+        case NAND:
+        case OR:
+            return v == 1;
+        case XOR:
+        case XNOR:
+            return true;
+        default:
+            return false;
+    }
+}
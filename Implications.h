@@ -0,0 +1,49 @@
+/* header for Implications class
+   Static learning in the style of SOCRATES. Every node is set to 0 and
+   to 1 in turn and the direct implications of that single assignment
+   are propagated forwards and backwards. For each node m that ends up
+   at w in the forward direction, the contrapositive (m = ~w) => (n = ~v)
+   is stored when a plain backward implication from m = ~w cannot derive
+   it, i.e. when ~w is the controlled value of m's gate (or m is an XOR).
+   The learned implications are kept in compressed sparse row form,
+   indexed by literal (2 * node index + value).
+*/
+#ifndef IMPLICATIONS_H
+#define IMPLICATIONS_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+
+#define LEARN_X 2
+
+class Implications {
+    private:
+        Netlist* netlist;
+        vector<int> litStart;           // size 2 * numNodes + 1
+        vector<int> lits;               // implied literals
+
+        vector<char> values;            // 0, 1 or LEARN_X while learning
+        vector<int> assigned;           // nodes set by the current trial
+        vector<int> pending;             // assigned nodes still to imply from
+
+        bool assign(int idx, char v);
+        bool implyAll();
+        bool forward(int idx);
+        bool backward(int idx);
+        bool learnable(int idx, char v);
+        void clearValues();
+
+    public:
+        Implications(Netlist* netlist);
+
+        inline Netlist* getNetlist() {return netlist;};
+        inline int getNumLearned() const {return lits.size();};
+        inline int getNumImplied(int idx, int v) const {return litStart[2 * idx + v + 1] - litStart[2 * idx + v];};
+        inline const int* getImplied(int idx, int v) const {return lits.data() + litStart[2 * idx + v];};
+        inline static int litNode(int lit) {return lit >> 1;};
+        inline static int litValue(int lit) {return lit & 1;};
+};
+
+#include "Implications.cpp"
+#endif
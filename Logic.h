@@ -39,6 +39,7 @@ inline LOGIC operator&(LOGIC const &a, LOGIC const &b) {
     if (a == X || b == X) {return X;}
     if (a == ONE) {return b;}
     if (b == ONE) {return a;}
+    if (a == b) {return a;}
     return ZERO;
 }
 
@@ -0,0 +1,66 @@
+/* Netlist class
+*/
+
+#include "Netlist.h"
+
+static bool levelThenID(cktNode* a, cktNode* b) {
+    if (a->getLevel() != b->getLevel()) {
+        return a->getLevel() < b->getLevel();
+    }
+    return a->getNodeID() < b->getNodeID();
+}
+
+Netlist::Netlist(cktMap* nodes, cktList* PInodes, cktList* POnodes) {
+    cktList ordered;
+    int maxID = 0;
+    maxLevel = 0;
+
+    for (cktMap::iterator it = nodes->begin(); it != nodes->end(); ++it) {
+        ordered.push_back(it->second);
+        maxID = max(maxID, it->first);
+        maxLevel = max(maxLevel, it->second->getLevel());
+    }
+    sort(ordered.begin(), ordered.end(), levelThenID);
+
+    numNodes = ordered.size();
+    idToIndex.assign(maxID + 1, -1);
+    for (int i = 0; i < numNodes; i++) {
+        cktNode* currNode = ordered[i];
+        currNode->setIndex(i);
+        idToIndex[currNode->getNodeID()] = i;
+        nodeIDs.push_back(currNode->getNodeID());
+        gateTypes.push_back(currNode->getGateType());
+        nodeTypes.push_back(currNode->getNodeType());
+        levels.push_back(max(currNode->getLevel(), 0));
+    }
+
+    faninStart.push_back(0);
+    fanoutStart.push_back(0);
+    for (int i = 0; i < numNodes; i++) {
+        const cktList& usl = ordered[i]->getUpstreamList();
+        const cktList& dsl = ordered[i]->getDownstreamList();
+        for (int j = 0; j < usl.size(); j++) {
+            fanins.push_back(usl[j]->getIndex());
+        }
+        for (int j = 0; j < dsl.size(); j++) {
+            fanouts.push_back(dsl[j]->getIndex());
+        }
+        faninStart.push_back(fanins.size());
+        fanoutStart.push_back(fanouts.size());
+    }
+
+    levelStart.assign(maxLevel + 2, numNodes);
+    for (int i = numNodes - 1; i >= 0; i--) {
+        levelStart[levels[i]] = i;
+    }
+    for (int l = maxLevel; l >= 0; l--) {
+        levelStart[l] = min(levelStart[l], levelStart[l + 1]);
+    }
+
+    for (int i = 0; i < PInodes->size(); i++) {
+        PIs.push_back((*PInodes)[i]->getIndex());
+    }
+    for (int i = 0; i < POnodes->size(); i++) {
+        POs.push_back((*POnodes)[i]->getIndex());
+    }
+}
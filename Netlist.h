@@ -0,0 +1,72 @@
+/* header for Netlist class
+   Immutable, densely indexed copy of the circuit topology. Nodes are
+   numbered 0..N-1 in levelized order, so index order is a valid
+   topological order. Fanins and fanouts are stored in compressed sparse
+   row form (one offset array plus one contiguous index array each).
+*/
+#ifndef NETLIST_H
+#define NETLIST_H
+
+#include "includes.h"
+#include "structures.h"
+#include "cktNode.h"
+
+class Netlist {
+    private:
+        int numNodes;
+        int maxLevel;
+
+        vector<int> nodeIDs;        // index -> node ID
+        vector<int> idToIndex;      // node ID -> index, -1 if unused
+        vector<gateT> gateTypes;
+        vector<nodeT> nodeTypes;
+        vector<int> levels;
+
+        vector<int> faninStart;     // size numNodes + 1
+        vector<int> fanins;
+        vector<int> fanoutStart;    // size numNodes + 1
+        vector<int> fanouts;
+
+        vector<int> levelStart;     // first index of each level, size maxLevel + 2
+        vector<int> PIs;
+        vector<int> POs;
+
+    public:
+        Netlist(cktMap* nodes, cktList* PInodes, cktList* POnodes);
+
+        inline int getNumNodes() const {return numNodes;};
+        inline int getMaxLevel() const {return maxLevel;};
+        inline int getIndex(int nodeID) const {return idToIndex[nodeID];};
+        inline int getNodeID(int idx) const {return nodeIDs[idx];};
+        inline gateT getGateType(int idx) const {return gateTypes[idx];};
+        inline nodeT getNodeType(int idx) const {return nodeTypes[idx];};
+        inline int getLevel(int idx) const {return levels[idx];};
+
+        inline int getNumFanIns(int idx) const {return faninStart[idx + 1] - faninStart[idx];};
+        inline const int* getFanIns(int idx) const {return fanins.data() + faninStart[idx];};
+        inline int getNumFanOuts(int idx) const {return fanoutStart[idx + 1] - fanoutStart[idx];};
+        inline const int* getFanOuts(int idx) const {return fanouts.data() + fanoutStart[idx];};
+
+        // Calls visit(in) for each input of fo other than idx; if idx
+        // drives fo more than once, only one occurrence is passed over
+        template<typename F> inline void forSideInputs(int fo, int idx, F visit) const {
+            const int* in = getFanIns(fo);
+            bool self = false;
+            for (int j = 0; j < getNumFanIns(fo); j++) {
+                if (in[j] == idx && !self) {
+                    self = true;
+                } else {
+                    visit(in[j]);
+                }
+            }
+        }
+
+        inline int getLevelBegin(int level) const {return levelStart[level];};
+        inline int getLevelEnd(int level) const {return levelStart[level + 1];};
+
+        inline const vector<int>& getPIs() const {return PIs;};
+        inline const vector<int>& getPOs() const {return POs;};
+};
+
+#include "Netlist.cpp"
+#endif
@@ -0,0 +1,181 @@
+/* PatternStore class
+*/
+
+#include "PatternStore.h"
+
+PatternStore::PatternStore(const vector<int>& piIDs) {
+    this->piIDs = piIDs;
+    sort(this->piIDs.begin(), this->piIDs.end());
+    words = max(1, (int) (this->piIDs.size() + 63) / 64);
+    count = 0;
+    used = 0;
+    table.assign(64, 0);
+}
+
+// FNV-1a over the words of both planes
+uint64_t PatternStore::hash(const uint64_t* p) const {
+    uint64_t h = 14695981039346656037ULL;
+    for (int w = 0; w < 2 * words; w++) {
+        h = (h ^ p[w]) * 1099511628211ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+// Both planes of test; PIs test leaves out are X
+void PatternStore::pack(const inputMap& test, uint64_t* p) const {
+    memset(p, 0, 2 * words * sizeof(uint64_t));
+    for (inputMap::const_iterator it = test.begin(); it != test.end(); ++it) {
+        if (it->second != ZERO && it->second != ONE) {
+            continue;
+        }
+        int pi = findPI(it->first);
+        if (pi < 0) {
+            continue;
+        }
+        p[pi / 64] |= 1ULL << (pi % 64);
+        if (it->second == ONE) {
+            p[words + pi / 64] |= 1ULL << (pi % 64);
+        }
+    }
+}
+
+// Stored vector equal to p, or -1
+int PatternStore::find(const uint64_t* p) const {
+    int mask = table.size() - 1;
+    for (int s = hash(p) & mask; table[s] != 0; s = (s + 1) & mask) {
+        if (table[s] > 0 && memcmp(care(table[s] - 1), p, 2 * words * sizeof(uint64_t)) == 0) {
+            return table[s] - 1;
+        }
+    }
+    return -1;
+}
+
+// Enters v in the index; a full table is doubled and rebuilt, which
+// enters every stored vector including v
+void PatternStore::index(int v) {
+    if (2 * (used + 1) > table.size()) {
+        table.assign(2 * table.size(), 0);
+        rebuildIndex();
+        return;
+    }
+    int mask = table.size() - 1;
+    int s = hash(care(v)) & mask;
+    while (table[s] > 0) {
+        s = (s + 1) & mask;
+    }
+    used += (table[s] == 0);
+    table[s] = v + 1;
+}
+
+// Leaves a removed mark so later probes still pass the slot
+void PatternStore::unindex(int v) {
+    int mask = table.size() - 1;
+    for (int s = hash(care(v)) & mask; table[s] != 0; s = (s + 1) & mask) {
+        if (table[s] == v + 1) {
+            table[s] = -1;
+            return;
+        }
+    }
+}
+
+void PatternStore::rebuildIndex() {
+    while (2 * count > table.size()) {
+        table.resize(2 * table.size());
+    }
+    table.assign(table.size(), 0);
+    used = 0;
+    for (int v = 0; v < count; v++) {
+        index(v);
+    }
+}
+
+int PatternStore::append(const uint64_t* p) {
+    arena.insert(arena.end(), p, p + 2 * words);
+    index(count++);
+    return count - 1;
+}
+
+// Adds test unless an equal vector is stored; returns its position
+int PatternStore::add(const inputMap& test) {
+    vector<uint64_t> p(2 * words);
+    pack(test, &p[0]);
+    int v = find(&p[0]);
+    return (v >= 0) ? v : append(&p[0]);
+}
+
+// Like add(), but a cube is first merged into the first stored vector
+// that assigns no PI the other value, taking on the PIs only the cube
+// assigns. A test for the cube's fault stays a test after the merge.
+int PatternStore::addCompatible(const inputMap& test) {
+    vector<uint64_t> p(2 * words);
+    pack(test, &p[0]);
+    int v = find(&p[0]);
+    if (v >= 0) {
+        return v;
+    }
+    vector<uint64_t> merged(2 * words);
+    for (v = 0; v < count; v++) {
+        const uint64_t* c = care(v);
+        const uint64_t* val = value(v);
+        bool agrees = true;
+        for (int w = 0; w < words && agrees; w++) {
+            agrees = ((c[w] & p[w]) & (val[w] ^ p[words + w])) == 0;
+        }
+        if (!agrees) {
+            continue;
+        }
+        for (int w = 0; w < words; w++) {
+            merged[w] = c[w] | p[w];
+            merged[words + w] = val[w] | p[words + w];
+        }
+        int same = find(&merged[0]);
+        if (same >= 0) {
+            return same;
+        }
+        unindex(v);
+        memcpy(care(v), &merged[0], 2 * words * sizeof(uint64_t));
+        index(v);
+        return v;
+    }
+    return append(&p[0]);
+}
+
+// Keeps only the given vectors, in the given order
+void PatternStore::keep(const vector<int>& vectors) {
+    vector<uint64_t> kept;
+    kept.reserve(vectors.size() * 2 * words);
+    for (int i = 0; i < vectors.size(); i++) {
+        kept.insert(kept.end(), care(vectors[i]), care(vectors[i]) + 2 * words);
+    }
+    arena.swap(kept);
+    count = vectors.size();
+    rebuildIndex();
+}
+
+void PatternStore::clear() {
+    arena.clear();
+    count = 0;
+    table.assign(64, 0);
+    used = 0;
+}
+
+LOGIC PatternStore::getValue(int v, int pi) const {
+    if (!((care(v)[pi / 64] >> (pi % 64)) & 1)) {
+        return X;
+    }
+    return ((value(v)[pi / 64] >> (pi % 64)) & 1) ? ONE : ZERO;
+}
+
+// Position of a PI node ID, or -1
+int PatternStore::findPI(int nodeID) const {
+    int pi = lower_bound(piIDs.begin(), piIDs.end(), nodeID) - piIDs.begin();
+    return (pi < piIDs.size() && piIDs[pi] == nodeID) ? pi : -1;
+}
+
+// Vector v as a map from PI node ID to value
+void PatternStore::getTest(int v, inputMap* test) const {
+    test->clear();
+    for (int pi = 0; pi < piIDs.size(); pi++) {
+        (*test)[piIDs[pi]] = getValue(v, pi);
+    }
+}
@@ -0,0 +1,53 @@
+/* header for PatternStore class
+   Test vectors over a fixed set of PIs, kept in insertion order. Each
+   vector takes two bit planes in one arena: a care plane with a bit per
+   PI that is 0 or 1, and a value plane holding that value, so X is care
+   0. PIs are in node ID order. An open-addressing hash index over the
+   packed words finds duplicates; addCompatible() also merges a cube
+   into the first stored vector it agrees with on every PI both assign.
+*/
+#ifndef PATTERNSTORE_H
+#define PATTERNSTORE_H
+
+#include "includes.h"
+#include "structures.h"
+
+class PatternStore {
+    private:
+        vector<int> piIDs;                  // node ID of each PI, sorted
+        int words;                          // words per plane
+        int count;
+        vector<uint64_t> arena;             // care plane then value plane, per vector
+        vector<int> table;                  // hash index: vector + 1, 0 empty, -1 removed
+        int used;                           // table slots not empty
+
+        inline uint64_t* care(int v) {return &arena[(size_t) v * 2 * words];};
+        inline uint64_t* value(int v) {return &arena[((size_t) v * 2 + 1) * words];};
+        inline const uint64_t* care(int v) const {return &arena[(size_t) v * 2 * words];};
+        inline const uint64_t* value(int v) const {return &arena[((size_t) v * 2 + 1) * words];};
+        uint64_t hash(const uint64_t* p) const;
+        void pack(const inputMap& test, uint64_t* p) const;
+        int find(const uint64_t* p) const;
+        void index(int v);
+        void unindex(int v);
+        void rebuildIndex();
+        int append(const uint64_t* p);
+
+    public:
+        PatternStore(const vector<int>& piIDs);
+
+        int     add(const inputMap& test);
+        int     addCompatible(const inputMap& test);
+        void    keep(const vector<int>& vectors);
+        void    clear();
+        LOGIC   getValue(int v, int pi) const;
+        void    getTest(int v, inputMap* test) const;
+        inline int size() const {return count;};
+        inline int getNumPI() const {return piIDs.size();};
+        inline int getPI(int pi) const {return piIDs[pi];};
+        int     findPI(int nodeID) const;
+        inline size_t getBytes() const {return arena.size() * sizeof(uint64_t) + table.size() * sizeof(int);};
+};
+
+#include "PatternStore.cpp"
+#endif
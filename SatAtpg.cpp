@@ -0,0 +1,180 @@
+/* SatAtpg class
+*/
+
+#include "SatAtpg.h"
+
+SatAtpg::SatAtpg(Netlist* netlist) {
+    this->netlist = netlist;
+    int n = netlist->getNumNodes();
+    inCone.resize(n);
+    inSupport.resize(n);
+    goodVar.resize(n);
+    faultyVar.resize(n);
+    dVar.resize(n);
+}
+
+// out = AND(ins), all literals; NAND, OR and NOR are built from this
+// by negating the output and/or the inputs
+void SatAtpg::addAnd(SatSolver& solver, int out, const vector<int>& ins) {
+    vector<int> big(1, out);
+    for (int i = 0; i < ins.size(); i++) {
+        vector<int> c;
+        c.push_back(SatSolver::negLit(out));
+        c.push_back(ins[i]);
+        solver.addClause(c);
+        big.push_back(SatSolver::negLit(ins[i]));
+    }
+    solver.addClause(big);
+}
+
+void SatAtpg::addXor(SatSolver& solver, int out, int a, int b) {
+    int na = SatSolver::negLit(a);
+    int nb = SatSolver::negLit(b);
+    int nout = SatSolver::negLit(out);
+    int c[4][3] = {{nout, a, b}, {nout, na, nb}, {out, na, b}, {out, a, nb}};
+    for (int i = 0; i < 4; i++) {
+        solver.addClause(vector<int>(c[i], c[i] + 3));
+    }
+}
+
+void SatAtpg::addGate(SatSolver& solver, gateT type, int out, const vector<int>& ins) {
+    int nout = SatSolver::negLit(out);
+    vector<int> negIns;
+    for (int i = 0; i < ins.size(); i++) {
+        negIns.push_back(SatSolver::negLit(ins[i]));
+    }
+
+    switch (type) {
+        case AND:
+            addAnd(solver, out, ins);
+            break;
+        case NAND:
+            addAnd(solver, nout, ins);
+            break;
+        case OR:
+            addAnd(solver, nout, negIns);
+            break;
+        case NOR:
+            addAnd(solver, out, negIns);
+            break;
+        case XOR:
+        case XNOR: {
+            // chain of two-input XORs, the last one driving the output
+            int target = (type == XNOR) ? nout : out;
+            int acc = ins[0];
+            for (int i = 1; i < ins.size(); i++) {
+                int t = (i + 1 == ins.size()) ? target : SatSolver::mkLit(solver.newVar(), false);
+                addXor(solver, t, acc, ins[i]);
+                acc = t;
+            }
+            if (ins.size() == 1) {
+                addAnd(solver, target, ins);
+            }
+            break;
+        }
+        case NOT:
+            addAnd(solver, nout, ins);
+            break;
+        default:                        // BRCH, and IPT driven by a gate
+            addAnd(solver, out, ins);
+            break;
+    }
+}
+
+// Returns SAT_SAT with a test in piValues (X for PIs outside the
+// fault's support), SAT_UNSAT for a redundant fault, or SAT_UNKNOWN
+// when the conflict or time budget runs out.
+int SatAtpg::generate(int nodeIdx, int sav, vector<LOGIC>& piValues, double timeBudget) {
+    int n = netlist->getNumNodes();
+    SatSolver solver;
+
+    // the cone follows index order, the support is found backwards
+    fill(inCone.begin(), inCone.end(), 0);
+    inCone[nodeIdx] = 1;
+    for (int idx = nodeIdx + 1; idx < n; idx++) {
+        const int* fi = netlist->getFanIns(idx);
+        for (int i = 0; i < netlist->getNumFanIns(idx) && !inCone[idx]; i++) {
+            inCone[idx] = inCone[fi[i]];
+        }
+    }
+    for (int idx = n - 1; idx >= 0; idx--) {
+        inSupport[idx] = inCone[idx];
+        const int* fo = netlist->getFanOuts(idx);
+        for (int i = 0; i < netlist->getNumFanOuts(idx) && !inSupport[idx]; i++) {
+            inSupport[idx] = inSupport[fo[i]];
+        }
+    }
+
+    for (int idx = 0; idx < n; idx++) {
+        if (inSupport[idx]) {
+            goodVar[idx] = SatSolver::mkLit(solver.newVar(), false);
+        }
+        if (inCone[idx]) {
+            faultyVar[idx] = SatSolver::mkLit(solver.newVar(), false);
+            dVar[idx] = SatSolver::mkLit(solver.newVar(), false);
+        }
+    }
+
+    vector<int> ins;
+    vector<int> c;
+    for (int idx = 0; idx < n; idx++) {
+        if (!inSupport[idx] || netlist->getNumFanIns(idx) == 0) {
+            continue;
+        }
+        const int* fi = netlist->getFanIns(idx);
+        int numIns = netlist->getNumFanIns(idx);
+
+        ins.clear();
+        for (int i = 0; i < numIns; i++) {
+            ins.push_back(goodVar[fi[i]]);
+        }
+        addGate(solver, netlist->getGateType(idx), goodVar[idx], ins);
+
+        if (inCone[idx] && idx != nodeIdx) {
+            ins.clear();
+            for (int i = 0; i < numIns; i++) {
+                ins.push_back(inCone[fi[i]] ? faultyVar[fi[i]] : goodVar[fi[i]]);
+            }
+            addGate(solver, netlist->getGateType(idx), faultyVar[idx], ins);
+        }
+    }
+
+    // D chain: a difference at a non-PO node must reach one of its fanouts
+    for (int idx = nodeIdx; idx < n; idx++) {
+        if (!inCone[idx]) {
+            continue;
+        }
+        int d = SatSolver::negLit(dVar[idx]);
+        int g = goodVar[idx];
+        int f = faultyVar[idx];
+        int cl[2][3] = {{d, g, f}, {d, SatSolver::negLit(g), SatSolver::negLit(f)}};
+        solver.addClause(vector<int>(cl[0], cl[0] + 3));
+        solver.addClause(vector<int>(cl[1], cl[1] + 3));
+
+        if (netlist->getNodeType(idx) != PO) {
+            c.assign(1, d);
+            const int* fo = netlist->getFanOuts(idx);
+            for (int i = 0; i < netlist->getNumFanOuts(idx); i++) {
+                c.push_back(dVar[fo[i]]);
+            }
+            solver.addClause(c);
+        }
+    }
+
+    // fault site: stuck in the faulty machine, activated in the good one
+    solver.addClause(vector<int>(1, faultyVar[nodeIdx] ^ !sav));
+    solver.addClause(vector<int>(1, goodVar[nodeIdx] ^ sav));
+    solver.addClause(vector<int>(1, dVar[nodeIdx]));
+
+    int result = solver.solve(MAXSATCONFLICTS, timeBudget);
+    if (result == SAT_SAT) {
+        const vector<int>& PIs = netlist->getPIs();
+        piValues.assign(PIs.size(), X);
+        for (int i = 0; i < PIs.size(); i++) {
+            if (inSupport[PIs[i]]) {
+                piValues[i] = solver.modelValue(goodVar[PIs[i]] >> 1) ? ONE : ZERO;
+            }
+        }
+    }
+    return result;
+}
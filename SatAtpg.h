@@ -0,0 +1,39 @@
+/* header for SatAtpg class
+   SAT-based test generation for a single stuck-at fault. The fault's
+   fanout cone is copied into a faulty machine and compared with the
+   good machine over the cone and its transitive fanin. Every cone node
+   gets a D variable meaning "good and faulty differ here"; the D at the
+   fault site must be carried to some fanout until a PO is reached, so
+   a satisfying assignment is a test and an UNSAT result proves the
+   fault redundant.
+*/
+#ifndef SATATPG_H
+#define SATATPG_H
+
+#include "includes.h"
+#include "structures.h"
+#include "defines.h"
+#include "Netlist.h"
+#include "SatSolver.h"
+
+class SatAtpg {
+    private:
+        Netlist* netlist;
+        vector<char> inCone;            // fanout cone of the fault site
+        vector<char> inSupport;         // cone plus its transitive fanin
+        vector<int> goodVar;
+        vector<int> faultyVar;
+        vector<int> dVar;
+
+        void addGate(SatSolver& solver, gateT type, int out, const vector<int>& ins);
+        void addAnd(SatSolver& solver, int out, const vector<int>& ins);
+        void addXor(SatSolver& solver, int out, int a, int b);
+
+    public:
+        SatAtpg(Netlist* netlist);
+
+        int generate(int nodeIdx, int sav, vector<LOGIC>& piValues, double timeBudget);
+};
+
+#include "SatAtpg.cpp"
+#endif
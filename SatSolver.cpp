@@ -0,0 +1,330 @@
+/* SatSolver class
+*/
+
+#include "SatSolver.h"
+
+SatSolver::SatSolver() {
+    numVars = 0;
+    unsat = false;
+    qhead = 0;
+    varInc = 1.0;
+}
+
+int SatSolver::newVar() {
+    int var = numVars++;
+    watches.push_back(vector<int>());
+    watches.push_back(vector<int>());
+    assigns.push_back(SAT_UNDEF);
+    levels.push_back(0);
+    reasons.push_back(-1);
+    polarity.push_back(0);
+    seen.push_back(0);
+    activity.push_back(0.0);
+    heapPos.push_back(-1);
+    heapInsert(var);
+    return var;
+}
+
+// Adds a clause at level 0. Returns false once the formula is known to
+// be unsatisfiable.
+bool SatSolver::addClause(vector<int> lits) {
+    if (unsat) {
+        return false;
+    }
+    sort(lits.begin(), lits.end());
+    int k = 0;
+    for (int i = 0; i < lits.size(); i++) {
+        int v = value(lits[i]);
+        if (v == 1 || (i > 0 && lits[i] == negLit(lits[i - 1]))) {
+            return true;            // satisfied or tautology
+        }
+        if (v == 0 || (k > 0 && lits[k - 1] == lits[i])) {
+            continue;               // false at level 0 or duplicate
+        }
+        lits[k++] = lits[i];
+    }
+    lits.resize(k);
+
+    if (lits.empty()) {
+        unsat = true;
+    } else if (lits.size() == 1) {
+        enqueue(lits[0], -1);
+        unsat = propagate() >= 0;
+    } else {
+        int ci = clauses.size();
+        clauses.push_back(lits);
+        watches[lits[0]].push_back(ci);
+        watches[lits[1]].push_back(ci);
+    }
+    return !unsat;
+}
+
+void SatSolver::enqueue(int lit, int reason) {
+    int var = lit >> 1;
+    assigns[var] = !(lit & 1);
+    levels[var] = decisionLevel();
+    reasons[var] = reason;
+    trail.push_back(lit);
+}
+
+// Unit propagation over the watched literals; returns the conflicting
+// clause or -1
+int SatSolver::propagate() {
+    while (qhead < trail.size()) {
+        int falseLit = negLit(trail[qhead++]);
+        vector<int>& ws = watches[falseLit];
+        int i = 0;
+        int j = 0;
+        while (i < ws.size()) {
+            int ci = ws[i++];
+            vector<int>& c = clauses[ci];
+            if (c[0] == falseLit) {
+                swap(c[0], c[1]);
+            }
+            if (value(c[0]) == 1) {
+                ws[j++] = ci;
+                continue;
+            }
+
+            bool moved = false;
+            for (int k = 2; k < c.size(); k++) {
+                if (value(c[k]) != 0) {
+                    swap(c[1], c[k]);
+                    watches[c[1]].push_back(ci);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) {
+                continue;
+            }
+
+            ws[j++] = ci;
+            if (value(c[0]) == 0) {
+                while (i < ws.size()) {
+                    ws[j++] = ws[i++];
+                }
+                ws.resize(j);
+                qhead = trail.size();
+                return ci;
+            }
+            enqueue(c[0], ci);
+        }
+        ws.resize(j);
+    }
+    return -1;
+}
+
+// First-UIP conflict analysis. learnt[0] is the asserting literal and
+// learnt[1] (if any) one from the level to jump back to.
+void SatSolver::analyze(int confl, vector<int>& learnt, int& backLevel) {
+    int pathC = 0;
+    int p = -1;
+    int idx = trail.size() - 1;
+    learnt.assign(1, -1);
+
+    do {
+        vector<int>& c = clauses[confl];
+        for (int j = (p == -1) ? 0 : 1; j < c.size(); j++) {
+            int var = c[j] >> 1;
+            if (!seen[var] && levels[var] > 0) {
+                seen[var] = 1;
+                bumpVar(var);
+                if (levels[var] >= decisionLevel()) {
+                    pathC++;
+                } else {
+                    learnt.push_back(c[j]);
+                }
+            }
+        }
+        while (!seen[trail[idx] >> 1]) {
+            idx--;
+        }
+        p = trail[idx--];
+        confl = reasons[p >> 1];
+        seen[p >> 1] = 0;
+        pathC--;
+    } while (pathC > 0);
+    learnt[0] = negLit(p);
+
+    backLevel = 0;
+    int maxPos = 1;
+    for (int i = 1; i < learnt.size(); i++) {
+        seen[learnt[i] >> 1] = 0;
+        if (levels[learnt[i] >> 1] > backLevel) {
+            backLevel = levels[learnt[i] >> 1];
+            maxPos = i;
+        }
+    }
+    if (learnt.size() > 1) {
+        swap(learnt[1], learnt[maxPos]);
+    }
+}
+
+void SatSolver::backtrack(int level) {
+    if (decisionLevel() <= level) {
+        return;
+    }
+    for (int i = trail.size() - 1; i >= trailLim[level]; i--) {
+        int var = trail[i] >> 1;
+        polarity[var] = assigns[var];
+        assigns[var] = SAT_UNDEF;
+        reasons[var] = -1;
+        heapInsert(var);
+    }
+    trail.resize(trailLim[level]);
+    trailLim.resize(level);
+    qhead = trail.size();
+}
+
+void SatSolver::bumpVar(int var) {
+    activity[var] += varInc;
+    if (activity[var] > 1e100) {
+        for (int v = 0; v < numVars; v++) {
+            activity[v] *= 1e-100;
+        }
+        varInc *= 1e-100;
+    }
+    if (heapPos[var] >= 0) {
+        heapUp(heapPos[var]);
+    }
+}
+
+void SatSolver::heapUp(int pos) {
+    int var = heap[pos];
+    while (pos > 0 && activity[heap[(pos - 1) / 2]] < activity[var]) {
+        heap[pos] = heap[(pos - 1) / 2];
+        heapPos[heap[pos]] = pos;
+        pos = (pos - 1) / 2;
+    }
+    heap[pos] = var;
+    heapPos[var] = pos;
+}
+
+void SatSolver::heapDown(int pos) {
+    int var = heap[pos];
+    int n = heap.size();
+    while (2 * pos + 1 < n) {
+        int child = 2 * pos + 1;
+        if (child + 1 < n && activity[heap[child + 1]] > activity[heap[child]]) {
+            child++;
+        }
+        if (activity[heap[child]] <= activity[var]) {
+            break;
+        }
+        heap[pos] = heap[child];
+        heapPos[heap[pos]] = pos;
+        pos = child;
+    }
+    heap[pos] = var;
+    heapPos[var] = pos;
+}
+
+void SatSolver::heapInsert(int var) {
+    if (heapPos[var] >= 0) {
+        return;
+    }
+    heap.push_back(var);
+    heapUp(heap.size() - 1);
+}
+
+int SatSolver::heapPop() {
+    int var = heap[0];
+    heapPos[var] = -1;
+    heap[0] = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heapPos[heap[0]] = 0;
+        heapDown(0);
+    }
+    return var;
+}
+
+// Luby restart sequence 1 1 2 1 1 2 4 ...
+int SatSolver::luby(int i) {
+    int size = 1;
+    int seq = 0;
+    while (size < i + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) >> 1;
+        seq--;
+        i = i % size;
+    }
+    return 1 << seq;
+}
+
+// Returns SAT_SAT (model in modelValue()), SAT_UNSAT, or SAT_UNKNOWN
+// after conflictBudget conflicts or timeBudget seconds (no time limit
+// if timeBudget <= 0)
+int SatSolver::solve(long conflictBudget, double timeBudget) {
+    if (unsat) {
+        return SAT_UNSAT;
+    }
+    struct timeval begin, now;
+    gettimeofday(&begin, 0);
+
+    long conflicts = 0;
+    int restarts = 0;
+    long restartLimit = 64 * luby(restarts);
+    long sinceRestart = 0;
+    vector<int> learnt;
+
+    while (true) {
+        int confl = propagate();
+        if (confl >= 0) {
+            conflicts++;
+            sinceRestart++;
+            if (decisionLevel() == 0) {
+                unsat = true;
+                return SAT_UNSAT;
+            }
+            int backLevel;
+            analyze(confl, learnt, backLevel);
+            backtrack(backLevel);
+            if (learnt.size() == 1) {
+                enqueue(learnt[0], -1);
+            } else {
+                int ci = clauses.size();
+                clauses.push_back(learnt);
+                watches[learnt[0]].push_back(ci);
+                watches[learnt[1]].push_back(ci);
+                enqueue(learnt[0], ci);
+            }
+            varInc /= 0.95;
+
+            if (conflicts >= conflictBudget) {
+                backtrack(0);
+                return SAT_UNKNOWN;
+            }
+            if (timeBudget > 0 && conflicts % 256 == 0) {
+                gettimeofday(&now, 0);
+                if ((now.tv_sec - begin.tv_sec) + (now.tv_usec - begin.tv_usec) * 1e-6 > timeBudget) {
+                    backtrack(0);
+                    return SAT_UNKNOWN;
+                }
+            }
+            if (sinceRestart >= restartLimit) {
+                backtrack(0);
+                sinceRestart = 0;
+                restartLimit = 64 * luby(++restarts);
+            }
+            continue;
+        }
+
+        int next = -1;
+        while (!heap.empty() && next < 0) {
+            int var = heapPop();
+            if (assigns[var] == SAT_UNDEF) {
+                next = var;
+            }
+        }
+        if (next < 0) {
+            return SAT_SAT;
+        }
+        trailLim.push_back(trail.size());
+        enqueue(mkLit(next, !polarity[next]), -1);
+    }
+}
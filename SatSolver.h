@@ -0,0 +1,69 @@
+/* header for SatSolver class
+   Small CDCL SAT solver: two watched literals per clause, VSIDS
+   variable order kept in a binary heap, first-UIP clause learning with
+   non-chronological backjumping, phase saving and Luby restarts.
+   Variables are numbered from 0; a literal is 2 * var + sign, sign 1
+   meaning negated. Clauses are only added at decision level 0, before
+   solve() is called.
+*/
+#ifndef SATSOLVER_H
+#define SATSOLVER_H
+
+#include "includes.h"
+
+#define SAT_UNSAT 0
+#define SAT_SAT 1
+#define SAT_UNKNOWN 2       // conflict or time budget used up
+#define SAT_UNDEF 2         // unassigned variable value
+
+class SatSolver {
+    private:
+        int numVars;
+        bool unsat;                         // conflict found at level 0
+        vector<vector<int> > clauses;
+        vector<vector<int> > watches;       // literal -> clauses watching it
+        vector<char> assigns;               // 0, 1 or SAT_UNDEF per variable
+        vector<int> levels;
+        vector<int> reasons;                // implying clause, -1 for decisions
+        vector<int> trail;
+        vector<int> trailLim;               // trail length at each decision
+        int qhead;
+        vector<char> polarity;              // saved phase
+        vector<char> seen;
+
+        vector<double> activity;
+        double varInc;
+        vector<int> heap;                   // max-heap on activity
+        vector<int> heapPos;                // -1 when not in the heap
+
+        inline int value(int lit) const {
+            char a = assigns[lit >> 1];
+            return a == SAT_UNDEF ? SAT_UNDEF : a ^ (lit & 1);
+        };
+        inline int decisionLevel() const {return trailLim.size();};
+        void enqueue(int lit, int reason);
+        int propagate();
+        void analyze(int confl, vector<int>& learnt, int& backLevel);
+        void backtrack(int level);
+        void bumpVar(int var);
+        void heapUp(int pos);
+        void heapDown(int pos);
+        void heapInsert(int var);
+        int heapPop();
+        static int luby(int i);
+
+    public:
+        SatSolver();
+
+        int     newVar();
+        bool    addClause(vector<int> lits);
+        int     solve(long conflictBudget, double timeBudget);
+        inline bool modelValue(int var) const {return assigns[var] == 1;};
+        inline int  getNumVars() const {return numVars;};
+
+        inline static int mkLit(int var, bool negated) {return 2 * var + negated;};
+        inline static int negLit(int lit) {return lit ^ 1;};
+};
+
+#include "SatSolver.cpp"
+#endif
@@ -0,0 +1,105 @@
+/* Scoap class
+*/
+
+#include "Scoap.h"
+
+static inline int scoapAdd(int a, int b) {
+    return min(a + b, SCOAP_INF);
+}
+
+Scoap::Scoap(Netlist* netlist) {
+    controllability(netlist);
+    observability(netlist);
+}
+
+void Scoap::controllability(Netlist* netlist) {
+    int numNodes = netlist->getNumNodes();
+    cc0.assign(numNodes, SCOAP_INF);
+    cc1.assign(numNodes, SCOAP_INF);
+
+    for (int idx = 0; idx < numNodes; idx++) {
+        int nIn = netlist->getNumFanIns(idx);
+        const int* in = netlist->getFanIns(idx);
+        if (nIn == 0) {
+            cc0[idx] = 1;
+            cc1[idx] = 1;
+            continue;
+        }
+
+        int c0 = cc0[in[0]];
+        int c1 = cc1[in[0]];
+        gateT gate = netlist->getGateType(idx);
+        for (int j = 1; j < nIn; j++) {
+            switch (gate) {
+                case AND:
+                case NAND:
+                    c0 = min(c0, cc0[in[j]]);
+                    c1 = scoapAdd(c1, cc1[in[j]]);
+                    break;
+                case OR:
+                case NOR:
+                    c0 = scoapAdd(c0, cc0[in[j]]);
+                    c1 = min(c1, cc1[in[j]]);
+                    break;
+                case XOR:
+                case XNOR: {
+                    int t = min(scoapAdd(c0, cc1[in[j]]), scoapAdd(c1, cc0[in[j]]));
+                    c0 = min(scoapAdd(c0, cc0[in[j]]), scoapAdd(c1, cc1[in[j]]));
+                    c1 = t;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        if (gate == NAND || gate == NOR || gate == XNOR || gate == NOT) {
+            swap(c0, c1);
+        }
+        // a branch is the same wire as its stem
+        int step = (gate == BRCH) ? 0 : 1;
+        cc0[idx] = scoapAdd(c0, step);
+        cc1[idx] = scoapAdd(c1, step);
+    }
+}
+
+void Scoap::observability(Netlist* netlist) {
+    int numNodes = netlist->getNumNodes();
+    co.assign(numNodes, SCOAP_INF);
+
+    for (int idx = numNodes - 1; idx >= 0; idx--) {
+        if (netlist->getNodeType(idx) == PO) {
+            co[idx] = 0;
+        }
+        // a stem is as observable as its most observable branch
+        const int* fanouts = netlist->getFanOuts(idx);
+        for (int i = 0; i < netlist->getNumFanOuts(idx); i++) {
+            int fo = fanouts[i];
+            gateT gate = netlist->getGateType(fo);
+
+            // other inputs of fo held at the non-controlling value
+            int cost = co[fo];
+            netlist->forSideInputs(fo, idx, [&](int in) {
+                switch (gate) {
+                    case AND:
+                    case NAND:
+                        cost = scoapAdd(cost, cc1[in]);
+                        break;
+                    case OR:
+                    case NOR:
+                        cost = scoapAdd(cost, cc0[in]);
+                        break;
+                    case XOR:
+                    case XNOR:
+                        cost = scoapAdd(cost, min(cc0[in], cc1[in]));
+                        break;
+                    default:
+                        break;
+                }
+            });
+            if (gate != BRCH) {
+                cost = scoapAdd(cost, 1);
+            }
+            co[idx] = min(co[idx], cost);
+        }
+    }
+}
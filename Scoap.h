@@ -0,0 +1,36 @@
+/* header for Scoap class
+   SCOAP testability measures over the levelized netlist: CC0/CC1 are
+   the combinational 0/1 controllabilities (PIs cost 1, each gate adds 1)
+   and CO is the combinational observability (POs cost 0). Computed once
+   in two passes over the index order, forward for controllability and
+   backward for observability.
+*/
+#ifndef SCOAP_H
+#define SCOAP_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+
+#define SCOAP_INF (1 << 28)     // unreachable; sums are capped here
+
+class Scoap {
+    private:
+        vector<int> cc0;
+        vector<int> cc1;
+        vector<int> co;
+
+        void controllability(Netlist* netlist);
+        void observability(Netlist* netlist);
+
+    public:
+        Scoap(Netlist* netlist);
+
+        inline int getCC0(int idx) const {return cc0[idx];};
+        inline int getCC1(int idx) const {return cc1[idx];};
+        inline int getCC(int idx, LOGIC v) const {return v == ZERO ? cc0[idx] : cc1[idx];};
+        inline int getCO(int idx) const {return co[idx];};
+};
+
+#include "Scoap.cpp"
+#endif
@@ -0,0 +1,104 @@
+/* SimTape class
+*/
+
+#include "SimTape.h"
+
+//  3-valued tables, col and row indexes: 0, 1, X
+static const unsigned char TAPE_LOGIC3[3][3][3] = {
+    {   // AND
+        {0, 0, 0},
+        {0, 1, 2},
+        {0, 2, 2},
+    },
+    {   // OR
+        {0, 1, 2},
+        {1, 1, 1},
+        {2, 1, 2},
+    },
+    {   // XOR
+        {0, 1, 2},
+        {1, 0, 2},
+        {2, 2, 2},
+    },
+};
+static const unsigned char TAPE_NOT3[3] = {1, 0, 2};
+
+SimTape::SimTape(Netlist* netlist) {
+    values.assign(netlist->getNumNodes(), 2);
+
+    // netlist indices are already in levelized order
+    for (int i = 0; i < netlist->getNumNodes(); i++) {
+        if (netlist->getNodeType(i) == PI || netlist->getNumFanIns(i) == 0) {
+            continue;
+        }
+
+        TAPEINSTR instr;
+        instr.invert = 0;
+        switch (netlist->getGateType(i)) {
+            case OR:
+            case NOR:
+                instr.op = TAPE_OR;
+                break;
+            case XOR:
+            case XNOR:
+                instr.op = TAPE_XOR;
+                break;
+            default:
+                instr.op = TAPE_AND;
+                break;
+        }
+        switch (netlist->getGateType(i)) {
+            case NAND:
+            case NOR:
+            case XNOR:
+            case NOT:
+                instr.invert = 1;
+                break;
+            default:
+                break;
+        }
+
+        instr.out = i;
+        instr.begin = operands.size();
+        const int* fanins = netlist->getFanIns(i);
+        for (int j = 0; j < netlist->getNumFanIns(i); j++) {
+            operands.push_back(fanins[j]);
+        }
+        instr.end = operands.size();
+        tape.push_back(instr);
+    }
+}
+
+void SimTape::setValue(int idx, LOGIC v) {
+    switch (v) {
+        case ZERO:
+            values[idx] = 0;
+            break;
+        case ONE:
+            values[idx] = 1;
+            break;
+        default:
+            values[idx] = 2;
+            break;
+    }
+}
+
+LOGIC SimTape::getValue(int idx) {
+    static const LOGIC toLogic[3] = {ZERO, ONE, X};
+    return toLogic[values[idx]];
+}
+
+void SimTape::run() {
+    unsigned char* val = values.data();
+    const int* ops = operands.data();
+    const TAPEINSTR* end = tape.data() + tape.size();
+
+    for (const TAPEINSTR* in = tape.data(); in != end; ++in) {
+        const unsigned char (*table)[3] = TAPE_LOGIC3[in->op];
+        unsigned char v = val[ops[in->begin]];
+        for (int k = in->begin + 1; k < in->end; k++) {
+            v = table[v][val[ops[k]]];
+        }
+        val[in->out] = in->invert ? TAPE_NOT3[v] : v;
+    }
+}
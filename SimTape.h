@@ -0,0 +1,41 @@
+/* header for SimTape class
+   Compiled good-machine simulator. The netlist is lowered once into a
+   flat instruction tape in levelized order; each instruction folds a
+   3-valued (0/1/X) lookup table over a contiguous run of operand slots
+   and writes one output slot, so a full simulation is a single loop with
+   no queues and no recursion. Stuck-at faults are not modelled.
+*/
+#ifndef SIMTAPE_H
+#define SIMTAPE_H
+
+#include "includes.h"
+#include "structures.h"
+#include "Netlist.h"
+
+typedef struct tape_instr {
+    unsigned char op;       // TAPE_AND, TAPE_OR or TAPE_XOR
+    unsigned char invert;   // 1 for NAND, NOR, XNOR, NOT
+    int out;                // output slot
+    int begin;              // first operand
+    int end;                // one past last operand
+} TAPEINSTR;
+
+enum e_tapeOp {TAPE_AND = 0, TAPE_OR = 1, TAPE_XOR = 2};
+
+class SimTape {
+    private:
+        vector<TAPEINSTR> tape;
+        vector<int> operands;
+        vector<unsigned char> values;   // 0, 1 or 2 (X), indexed by netlist index
+
+    public:
+        SimTape(Netlist* netlist);
+
+        void    setValue(int idx, LOGIC v);
+        LOGIC   getValue(int idx);
+        void    run();
+        inline int getTapeLength() {return tape.size();};
+};
+
+#include "SimTape.cpp"
+#endif
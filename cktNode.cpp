@@ -2,10 +2,10 @@
 
 #include "cktNode.h"
 
-cktList cktNode::getUpstreamList(){
+const cktList& cktNode::getUpstreamList(){
     return upstreamNodes;
 }
-cktList cktNode::getDownstreamList(){
+const cktList& cktNode::getDownstreamList(){
     return downstreamNodes;
 }
 int cktNode::getNodeID() {
@@ -138,8 +138,9 @@ cktNode::cktNode(int id, int ln, gateT gt, nodeT nt, int fis, int fos, vector<in
     numFanIns = fis;
     numFanOuts = fos;
     upstreamIDs = usIDs;
-    downstreamIDs = *(new vector<int>());
+    downstreamIDs.clear();
     level = -1;
+    index = -1;
     value = X;
     tested = false;
 
@@ -176,34 +177,39 @@ void cktNode::setFault(int sav) {
     }
 }
 
-// Evaluate the two logics based on gateType
-LOGIC cktNode::eval(vector<LOGIC> args) {
-    if (gateType == NOT) {return ~args[0];}
-    if (gateType == BRCH || IPT) {return args[0];}
+// Folds the gate function over the current upstream values.
+// Known inputs are combined first, an X input can then only
+// be overridden by a controlling value.
+LOGIC cktNode::evalInputs() {
+    if (gateType == NOT) {return ~upstreamNodes[0]->getValue();}
+    if (gateType == BRCH) {return upstreamNodes[0]->getValue();}
 
     LOGIC newVal = X;
-    queue<LOGIC> notX = notXList();
-    bool hasXIn = !(notX.size() == upstreamNodes.size());
-    if (!notX.empty()) {
-        newVal = notX.front();
-        notX.pop();
-    }
-
-    while (!notX.empty()) {
-        LOGIC popped = notX.front();
-        notX.pop();
+    bool hasXIn = false;
+    bool first = true;
+    for (int i = 0; i < upstreamNodes.size(); i++) {
+        LOGIC in = upstreamNodes[i]->getValue();
+        if (in == X) {
+            hasXIn = true;
+            continue;
+        }
+        if (first) {
+            newVal = in;
+            first = false;
+            continue;
+        }
         switch (gateType) {
             case XNOR:
             case XOR:
-                newVal = newVal ^ popped;
+                newVal = newVal ^ in;
                 break;
             case OR:
             case NOR:
-                newVal = newVal | popped;
+                newVal = newVal | in;
                 break;
             case AND:
             case NAND:
-                newVal = newVal & popped;
+                newVal = newVal & in;
                 break;
             default:
                 cout << gateType << " evaluate error \n";
@@ -241,15 +247,16 @@ LOGIC cktNode::eval(vector<LOGIC> args) {
     return newVal;
 }
 
+// Evaluate the two logics based on gateType
+LOGIC cktNode::eval(vector<LOGIC> args) {
+    if (gateType == NOT) {return ~args[0];}
+    if (gateType == BRCH) {return args[0];}
+    return evalInputs();
+}
 
-LOGIC cktNode::eval(cktList args) {
-    vector<LOGIC> argList;
-
-    for (int i = 0; i < upstreamNodes.size(); i++) {
-        argList.push_back(upstreamNodes[i]->getValue());
-    }
 
-    return eval(argList);
+LOGIC cktNode::eval(cktList args) {
+    return evalInputs();
 }
 
 LOGIC cktNode::eval(cktList args, LOGIC ci) {
@@ -268,20 +275,9 @@ LOGIC cktNode::eval(LOGIC a, LOGIC b) {
 }
 
 
-queue<LOGIC> cktNode::notXList() {
-    queue<LOGIC> notX;
-    for (int i = 0; i < upstreamNodes.size(); i++) {
-        if (upstreamNodes[i]->getValue() != X) {
-            notX.push(upstreamNodes[i]->getValue());
-        }
-    }
-    return notX;
-}
-
-
 bool cktNode::evaluate() {
     assert(nodeType != PI);
-    LOGIC newValue = eval(this->upstreamNodes);
+    LOGIC newValue = evalInputs();
 
     if (newValue != this->value) {
         this->value = newValue;
@@ -18,6 +18,7 @@ class cktNode {
         vector<cktNode*> upstreamNodes;
         vector<cktNode*> downstreamNodes;
         int level;
+        int index;          // dense index assigned by Netlist
         bool linked;
 
         //mutable through public functions
@@ -25,13 +26,13 @@ class cktNode {
         bool stuckAt;
         LOGIC stuckAtValue;
         
+        LOGIC evalInputs();
         LOGIC eval(vector<LOGIC> args);
         LOGIC eval(vector<cktNode*> args);
         LOGIC eval(vector<cktNode*> args, LOGIC ci);
         LOGIC eval(LOGIC a, LOGIC b);
         bool implyFromOutput(LOGIC xSet);
         bool implyFromInputs(LOGIC xSet, bool NGate);
-        queue<LOGIC> notXList();
         vector<LOGIC> getInputList();
 
     public:
@@ -43,18 +44,20 @@ class cktNode {
         gateT getGateType();
         nodeT getNodeType() ;
         int getLevel();
+        int getIndex() {return index;};
         int getNumFanIns();
         int getNumFanOuts();
         LOGIC getValue();
         LOGIC getTrueValue();
 
-        vector<cktNode*> getUpstreamList();
-        vector<cktNode*> getDownstreamList();
+        const vector<cktNode*>& getUpstreamList();
+        const vector<cktNode*>& getDownstreamList();
 
         void link(map<int, cktNode*> *nodes); // call : void link(cktMap *nodes)
 
 
         void setLevel(int l) {level = l;};
+        void setIndex(int i) {index = i;};
         void setValue(LOGIC v);
         void setFault(int sav);
         void removeStuckAt() {stuckAt = false;}
@@ -70,8 +73,8 @@ class cktNode {
         void reset();
         void resetValue();
         bool faultMatch();
-        inline vector<int> getDownstreamIDs() {return downstreamIDs;};
-        inline vector<int> getUpstreamIDs() {return upstreamIDs;};
+        inline const vector<int>& getDownstreamIDs() {return downstreamIDs;};
+        inline const vector<int>& getUpstreamIDs() {return upstreamIDs;};
 
 };
 typedef map<int, cktNode*> cktMap;
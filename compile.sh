@@ -1 +1 @@
-gcc -fcompare-debug-second -Wno-format -o main main.cpp -lstdc++ -lm -ldl -g -std=c++11
+gcc -fcompare-debug-second -Wno-format -o main main.cpp -lstdc++ -lm -ldl -lpthread -g -std=c++11
@@ -8,11 +8,19 @@
 #define BIT0(num) ((num) & 0b01)
 #define BIT1(num) ((num) & 0b10)
 
-#define NUMFUNCS 17
+#define NUMFUNCS 19
 #define MAXLINE 100               /* Input buffer size */
 #define MAXNAME 31               /* File name size */
 #define N_DROP	5	  	//Drop faults after detected this many times
-#define MAXRANDOM 40
+#define MAXRANDOMBLOCKS 256	//blocks of 64 random patterns tried before deterministic ATPG
+#define RANDOMIDLEBLOCKS 4	//random phase ends after this many blocks in a row detect no fault
+#define RANDOMSEED 0x9e3779b97f4a7c15ULL
+#define MAXWEIGHTSETS 4	//weighted random phases, each with PI weights fitted to the faults left open
+#define MAXBACKTRACK 1000	//ATPG gives up on a fault after this many backtracks
+#define MAXFAULTTIME 1.0	//seconds of search per fault before it is aborted
+#define MAXSATCONFLICTS 20000	//SAT fallback gives up on a fault after this many conflicts
+#define MAXSECONDARY 64	//faults tried for each test cube by dynamic compaction
+#define MAXSECONDARYBACKTRACK 10	//backtrack limit when extending a test cube
 
 #define Upcase(x) ((isalpha(x) && islower(x))? toupper(x) : (x))
 #define Lowcase(x) ((isalpha(x) && isupper(x))? tolower(x) : (x))
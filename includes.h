@@ -7,6 +7,7 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 #include <assert.h>
 #include <sys/time.h>
 
@@ -23,6 +24,10 @@
 #include <set>
 #include <map>
 #include <queue>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
 
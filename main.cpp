@@ -7,6 +7,8 @@ Circuit * ckt = NULL;
 enum e_state Gstate;
 int Done = 0;
 char circuitFile[MAXLINE];
+int backtrackLimit = MAXBACKTRACK;      // per-fault ATPG limits, 0 for none
+double faultTimeLimit = MAXFAULTTIME;
 
 int main()
 {
@@ -14,7 +16,7 @@ int main()
    char cline[MAXLINE], wstr[MAXLINE], *cp;
 	
 	printf("EE658 Fault/Logic Simulator, Group 14\n");
-	printf("This processor bit width: %d\n", bitWidth);
+	printf("This processor bit width: %d\n", parallelWordBits());
 	
 	/* initialize random seed: */
 	srand(time(NULL));
@@ -63,19 +65,34 @@ void help(char*)
    printf("PFS inputPatterns inputFaults outputFaultsFound - ");
    printf("Performs parallel fault simulation\n");
 
-   printf("RTG numTests reportFile - ");
-   printf("Performs Random Test Generation and simulation\n");
+   printf("CFS inputPatterns inputFaults outputFaultsFound - ");
+   printf("Performs concurrent fault simulation, same files as PFS\n");
+
+   printf("CPT inputPatterns outputFaultsFound - ");
+   printf("Grades the collapsed fault list by critical path tracing\n");
+
+   printf("DFS inputPatterns outputFaultsFound - ");
+   printf("Performs deductive fault simulation, writes every detected fault\n");
+
+   printf("RTG numTests reportFile [WEIGHTED] [patternFile] - ");
+   printf("Performs Random Test Generation and simulation, writing the tests to patternFile if given\n");
+   printf("   WEIGHTED draws each PI with a 1 probability fitted by COP to the random pattern resistant faults\n");
 
    printf("PODEM node sav - ");
    printf("Performs PODEM to find a test vector for node@sav\n");
 
-   printf("ATPG cktFile algorithm - ");
-   printf("Performs dynamic ATPG using algorithm on circuit in cktFile\n");
+   printf("ATPG cktFile algorithm [LEARN] [ORDERED] - ");
+   printf("Performs dynamic ATPG using algorithm on circuit in cktFile, LEARN adds static learning\n");
 
-   printf("ATPG_DET cktFile algorithm - ");
-   printf("Performs ATPG using algorithm on circuit in cktFile\n");
+   printf("ATPG_DET cktFile algorithm [LEARN] [ORDERED] - ");
+   printf("Performs ATPG using algorithm on circuit in cktFile, LEARN adds static learning\n");
+   printf("   algorithm is PODEM, FAN or DALG (ATPG_DET only)\n");
+   printf("   PODEM and FAN run on ATPG_THREADS threads (default one per core); ORDERED makes the vectors independent of the thread count\n");
 
-   printf("LOGICSIM inputFile outputFile - ");
+   printf("LIMIT backtracks seconds - ");
+   printf("Sets the per-fault ATPG backtrack and time limits, 0 for no limit\n");
+
+   printf("LOGICSIM inputFile outputFile [EVENT|COMPILED|NATIVE] - ");
    printf("Reads input vectors from inputFile and writes simulation PO outputs to outputFile\n");
 
    printf("QUIT - ");
@@ -101,6 +118,14 @@ void cread(char *cp)
 	
    delete ckt;
    ckt = new Circuit(buf);
+   ckt->setLimits(backtrackLimit, faultTimeLimit);
+   learned_Dalg = NULL;
+   dominators_Dalg = ckt->getDominators();
+   compactor_Dalg = ckt->getCompactor();
+
+   //  NSTRUC view used by the PFS, DFS and D-algorithm engines
+   clear();
+   _cread(buf);
 
    Gstate = CKTLD;
 	printf("==> OK\n");
@@ -245,9 +270,14 @@ faultList * readFaults(char* filename) {
 void logicSim(char *cp) {
 	//  Read File	
 	//  Input in form "fileToRead.txt fileToWrite.txt"
+	//  Optional third argument selects the engine: EVENT (default),
+	//  COMPILED (interpreted tape) or NATIVE (generated code, 64 patterns per call)
 	char patternFile[MAXLINE];
 	char writeFile[MAXLINE];
-	sscanf(cp, "%s %s", patternFile, writeFile);
+	char mode[MAXLINE] = "EVENT";
+	sscanf(cp, "%s %s %s", patternFile, writeFile, mode);
+   bool compiled = (strcmp(mode, "COMPILED") == 0 || strcmp(mode, "compiled") == 0);
+   bool native = (strcmp(mode, "NATIVE") == 0 || strcmp(mode, "native") == 0);
 
    FILE *fptrOut;
    fptrOut = fopen(writeFile, "w");
@@ -270,7 +300,37 @@ void logicSim(char *cp) {
    }
    fprintf(fptrOut, "%d\n", POs.back()->getNodeID());
 
-   for (int i = 0; i < testVectors->size(); i++) {
+   if (native) {
+      CompiledSim* sim = ckt->getNativeSim();
+      Netlist* netlist = ckt->getNetlist();
+      printf("Native kernel: %s\n", sim->isNative() ? "loaded" : "unavailable, interpreting");
+      for (int base = 0; base < testVectors->size(); base += 64) {
+         int n = min(64, (int)testVectors->size() - base);
+         sim->clearInputs();
+         for (int b = 0; b < n; b++) {
+            inputMap* vec = (*testVectors)[base + b];
+            for (inputMap::iterator it = vec->begin(); it != vec->end(); ++it) {
+               sim->setInput(netlist->getIndex(it->first), b, it->second);
+            }
+         }
+         sim->run();
+         for (int b = 0; b < n; b++) {
+            for (int j = 0; j < POs.size(); j++) {
+               fprintf(fptrOut, j + 1 < POs.size() ? "%d," : "%d\n", sim->getValue(POs[j]->getIndex(), b));
+            }
+         }
+      }
+   }
+
+   for (int i = 0; i < testVectors->size() && !native; i++) {
+      if (compiled) {
+         ckt->simulateCompiled((*testVectors)[i]);
+         for (int j = 0; j < POs.size() - 1; j++) {
+            fprintf(fptrOut, "%d,", ckt->getCompiledValue(POs[j]->getNodeID()));
+         }
+         fprintf(fptrOut, "%d\n", ckt->getCompiledValue(POs.back()->getNodeID()));
+         continue;
+      }
       ckt->simulate((*testVectors)[i]);
       for (int j = 0; j < POs.size() - 1; j++) {
          fprintf(fptrOut, "%d,", (*POs[j]).getValue());
@@ -296,41 +356,35 @@ void rfl(char* cp) {
    printf("\n==OK\n");
 }
 
-void dfs(char* cp) {
-   char readFile[MAXLINE];
+void cpt(char* cp) {
+   //  Grades the collapsed fault list with critical path tracing
+   //  Input in form "patternFile.txt faultsFound.txt"; patterns as for LOGICSIM
+   char patternFile[MAXLINE];
    char writeFile[MAXLINE];
+   sscanf(cp, "%s %s", patternFile, writeFile);
 
-   sscanf(cp, "%s %s", readFile, writeFile);
-   inputList* testPatterns = readTestPatterns(readFile);
-   faultSet rflist = ckt->generateFaults(true);
-   faultMap* faultSimResults = ckt->deductiveFaultSim(&rflist, testPatterns);
+   inputList* testPatterns = readTestPatterns(patternFile);
+   if (testPatterns == NULL) {
+      cout << patternFile << " cannot be read.";
+      return;
+   }
+   faultSet faults = ckt->generateFaults(true);
+   faultSet undetected = faults;
+   faultMap* results = ckt->criticalPathFaultSim(&undetected, testPatterns);
 
    FILE* fptr;
    if((fptr = fopen(writeFile,"w")) == NULL) {
 		printf("File %s cannot be written!\n", writeFile);
 		return;
-	}else{
-		printf("==> Writing file: %s\n", writeFile);
 	}
-
-   char cname[MAXLINE];
-   sprintf(cname, "%s", ckt->getCktName().c_str());
-   fprintf(fptr, "%s\n", cname);
-   fprintf(fptr, "# of Vectors that detected a fault: %d", faultSimResults->size());
-   int testNum = 0;
-	int numFaults = 0;
-	for (faultMap::iterator it = faultSimResults->begin(); it != faultSimResults->end(); ++it) {
-		fprintf(fptr, "Test Vector\t#%d: %s tests:\n", testNum, it->first);
-		for (int i = 0; i < it->second->size(); i++) {
-         fprintf(fptr, "%s\n", it->second->at(i));
-			numFaults++;
-		}
-		cout << "\n\n";
-		testNum++;
-	}
-   fprintf(fptr, "# of faults detected: %d", numFaults);
+   for (faultSet::iterator it = faults.begin(); it != faults.end(); ++it) {
+      if (!undetected.count(*it)) {
+         fprintf(fptr, "%d@%d\n", (*it)->getNode()->getNodeID(), (*it)->getSAV());
+      }
+   }
    fclose(fptr);
-
+   printf("Fault Coverage: %.2f%%\n", 100.0 * (faults.size() - undetected.size()) / faults.size());
+   printf("==> Writing file of Faults Detected: %s\n", writeFile);
    printf("\n==> OK\n");
 }
 
@@ -367,13 +421,13 @@ void podem(char* cp) {
    printf("==> OK\n");
 }
 
-void podemATPGReport(double fc, double elapsedTime, inputSet* testVectors) {
+void podemATPGReport(const char* alg, double fc, double elapsedTime, PatternStore* testVectors, double learnTime) {
    FILE* fptr;
    FILE* pFile;
    char fileName[MAXLINE];
    char patternFile[MAXLINE];
-   sprintf(fileName, "ATPG_OUT/%s_PODEM_ATPG_report.txt", ckt->getCktName().c_str());
-   sprintf(patternFile, "ATPG_OUT/%s_PODEM_ATPG_patterns.txt", ckt->getCktName().c_str());
+   sprintf(fileName, "ATPG_OUT/%s_%s_ATPG_report.txt", ckt->getCktName().c_str(), alg);
+   sprintf(patternFile, "ATPG_OUT/%s_%s_ATPG_patterns.txt", ckt->getCktName().c_str(), alg);
    fptr = fopen(fileName, "w");
    pFile = fopen(patternFile, "w");
 
@@ -387,35 +441,58 @@ void podemATPGReport(double fc, double elapsedTime, inputSet* testVectors) {
       return;
    }
 
-   for(int i = 0; i < ckt->getNumPI(); i++) {
-      for (inputMap::iterator it = (*testVectors->begin())->begin();
-            it != (*testVectors->begin())->end(); ++it) {
-         fprintf(pFile, "%d ", it->first);
-      }
+   for (int pi = 0; pi < testVectors->getNumPI(); pi++) {
+      fprintf(pFile, "%d ", testVectors->getPI(pi));
    }
 
    fprintf(pFile, "\n");
-   int temp;
-   for (inputSet::iterator iset = testVectors->begin(); iset != testVectors->end(); ++iset) {
-      for(inputMap::iterator it = (*iset)->begin(); 
-                  it != (*iset)->end(); ++it){
+   for (int v = 0; v < testVectors->size(); v++) {
+      for (int pi = 0; pi < testVectors->getNumPI(); pi++) {
          stringstream ss;
-         ss << (LOGIC)it->second;
+         ss << testVectors->getValue(v, pi);
          fprintf(pFile, "%s ", ss.str().c_str());
       }
       fprintf(pFile, "\n");
    }
 
-   fprintf(fptr, "\nAlgorithm: PODEM\n");
+   fprintf(fptr, "\nAlgorithm: %s\n", alg);
    fprintf(fptr, "Circuit: %s\n", ckt->getCktName().c_str());
    fprintf(fptr, "Fault Coverage: %f\%\n", fc);
+   writeStats(fptr, ckt->getStats());
    fprintf(fptr, "Time: %0.3f\n", elapsedTime);
+   if (learnTime >= 0) {
+      fprintf(fptr, "Learning Time: %0.3f\n", learnTime);
+   }
    printf("\n==> Writing ATPG report: %s\n",fileName);
    fclose(fptr);
    fclose(pFile);
 }
 
 
+// True if name is one of the optional words after "cktFile algorithm"
+bool atpgOption(const char* cp, const char* name) {
+   char cktFile[MAXLINE], alg[MAXLINE], opt[2][MAXLINE];
+   int n = sscanf(cp, "%s %s %s %s", cktFile, alg, opt[0], opt[1]);
+   for (int i = 0; i + 2 < n; i++) {
+      if (strcasecmp(opt[i], name) == 0) {
+         return true;
+      }
+   }
+   return false;
+}
+
+// Static learning for ATPG when the optional LEARN argument is given.
+// Returns the learning time, or -1 if learning was not asked for.
+double atpgLearn(const char* cp) {
+   if (!atpgOption(cp, "LEARN")) {
+      return -1;
+   }
+   double learnTime = ckt->learn();
+   printf("Static learning: %d implications in %.3f seconds\n",
+         ckt->getImplications()->getNumLearned(), learnTime);
+   return learnTime;
+}
+
 void atpg_det(char* cp) {
    char cktFile[MAXLINE];
    char alg[MAXLINE];
@@ -423,9 +500,16 @@ void atpg_det(char* cp) {
    sscanf(cp, "%s %s", cktFile, alg);
    string algorithm = alg;
    double fc;
+   double learnTime;
    struct timeval begin, end;
-   inputSet testVectors;
-   if (algorithm.compare("PODEM") != 0 && algorithm.compare("podem") != 0) {
+   bool fan = strcasecmp(alg, "FAN") == 0;
+   if (strcasecmp(alg, "PODEM") != 0 && !fan) {
+      learned_Dalg = NULL;
+      learnTime_Dalg = -1;
+      if (ckt != NULL) {
+         learnTime_Dalg = atpgLearn(cp);
+         if (learnTime_Dalg >= 0) {learned_Dalg = ckt->getImplications();}
+      }
       printf("Starting DAlg...\n");
       ATPG_DET(cp);
       printf("Algorithm: Dalg\n");
@@ -433,10 +517,18 @@ void atpg_det(char* cp) {
       delete ckt;
       string cf = cktFile;
       ckt = new Circuit(cktFile);
+      ckt->setLimits(backtrackLimit, faultTimeLimit);
+      learned_Dalg = NULL;
+      dominators_Dalg = ckt->getDominators();
+      compactor_Dalg = ckt->getCompactor();
+      ckt->setOrdered(atpgOption(cp, "ORDERED"));
+      ckt->setFan(fan);
+      learnTime = atpgLearn(cp);
+      PatternStore testVectors(ckt->getPIs());
       gettimeofday(&begin,0);
       fc = ckt->atpg_det(&testVectors);
       gettimeofday(&end, 0);
-      printf("Algorithm: PODEM\n");
+      printf("Algorithm: %s\n", fan ? "FAN" : "PODEM");
       printf("Circuit: %s\n", ckt->getCktName().c_str());
       printf("Fault Coverage: %.2f\%\n", fc);
 
@@ -444,7 +536,7 @@ void atpg_det(char* cp) {
       long microseconds = end.tv_usec - begin.tv_usec;
       double elapsed = seconds + microseconds*1e-6;
       printf("Finished in %.3f seconds\n", elapsed);
-      podemATPGReport(fc, elapsed, &testVectors);
+      podemATPGReport(fan ? "FAN" : "PODEM", fc, elapsed, &testVectors, learnTime);
    }
    printf("==> OK\n");
 }
@@ -457,7 +549,8 @@ void atpg(char* cp) {
    string algorithm = alg;
    struct timeval begin, end;
    double fc;
-   inputSet testVectors;
+   double learnTime = -1;
+   PatternStore* testVectors = NULL;
    bool Dalg = false;
    if (Dalg && (strchr(alg,'p') != NULL || strchr(alg, 'P'))) {
       printf("Starting Dalg based ATPG...\n");
@@ -468,9 +561,17 @@ void atpg(char* cp) {
    } else {
       delete ckt;
       ckt = new Circuit(cktFile);
-      printf("Starting PODEM based ATPG...\n");
+      ckt->setLimits(backtrackLimit, faultTimeLimit);
+      learned_Dalg = NULL;
+      dominators_Dalg = ckt->getDominators();
+      compactor_Dalg = ckt->getCompactor();
+      ckt->setOrdered(atpgOption(cp, "ORDERED"));
+      ckt->setFan(strcasecmp(alg, "FAN") == 0);
+      learnTime = atpgLearn(cp);
+      printf("Starting %s based ATPG...\n", strcasecmp(alg, "FAN") == 0 ? "FAN" : "PODEM");
+      testVectors = new PatternStore(ckt->getPIs());
       gettimeofday(&begin,0);
-      fc = ckt->atpg(&testVectors);
+      fc = ckt->atpg(testVectors);
       gettimeofday(&end, 0);
       //output test vectors
    }
@@ -483,16 +584,28 @@ void atpg(char* cp) {
    long microseconds = end.tv_usec - begin.tv_usec;
    double elapsed = seconds + microseconds*1e-6;
    printf("Finished in %.3f seconds\n", elapsed);
-   podemATPGReport(fc, elapsed, &testVectors);
+   if (testVectors != NULL) {
+      podemATPGReport(strcasecmp(alg, "FAN") == 0 ? "FAN" : "PODEM", fc, elapsed, testVectors, learnTime);
+      delete testVectors;
+   }
    printf("==> OK\n");
 }
 
 void rtg(char* cp) {
    char reportFile[MAXLINE];
+   char opt[2][MAXLINE];
+   char* patternFile = NULL;
+   bool weighted = false;
    int nTests;
-   double fc;
 
-   sscanf(cp, "%d %f %s", &nTests, &fc, reportFile);
+   int n = sscanf(cp, "%d %s %s %s", &nTests, reportFile, opt[0], opt[1]);
+   for (int i = 0; i + 2 < n; i++) {
+      if (strcasecmp(opt[i], "WEIGHTED") == 0) {
+         weighted = true;
+      } else {
+         patternFile = opt[i];
+      }
+   }
 
    FILE *fptrOut;
    fptrOut = fopen(reportFile, "w");
@@ -502,7 +615,7 @@ void rtg(char* cp) {
 	}else{
 		printf("==> Writing file of PO outputs: %s\n",reportFile);
 	}
-   inputList randInputs = ckt->randomTestsGen(nTests);
+   inputList randInputs = weighted ? ckt->weightedTestsGen(nTests) : ckt->randomTestsGen(nTests);
 
    for (int i = 0; i < randInputs.size(); i++) {
       ckt->reset();
@@ -527,14 +640,38 @@ void rtg(char* cp) {
       fprintf(fptrOut, "%d\n", POs.back()->getValue());
    }
    fclose(fptrOut);
+   if (patternFile != NULL) {
+      setInputPatterns(randInputs);
+      writeInputPatterns(patternFile, true);
+      printf("==> Writing test pattern file: %s\n", patternFile);
+   }
 	printf("\n==> OK\n");
 
 }
-void pfs(char* cp) {}
+void pfs(char* cp) {
+   parallelFS(cp);
+}
+void cfs(char* cp) {
+   concurrentFS(cp);
+}
 void dalg(char* cp) {
    DALG(cp);
 }
 
+// Per-fault search limits for PODEM, its SAT fallback and the
+// D-algorithm; a fault that hits one is reported as aborted.
+void limit(char* cp) {
+   sscanf(cp, "%d %lf", &backtrackLimit, &faultTimeLimit);
+   backtrackLimit_Dalg = backtrackLimit;
+   timeLimit_Dalg = faultTimeLimit;
+   if (ckt != NULL) {
+      ckt->setLimits(backtrackLimit, faultTimeLimit);
+   }
+   printf("ATPG limits: %d backtracks, %.3f seconds per fault (0 = none)\n",
+         backtrackLimit, faultTimeLimit);
+   printf("==> OK\n");
+}
+
 void exit(char*) {
    Done = 1;
 }
\ No newline at end of file
@@ -19,15 +19,19 @@ void rfl(char *);
 void multi_dfs(char*);
 void printNode(char *);
 void pfs(char *);
+void cfs(char *);
+void cpt(char *);
 void rtg(char *);
 void atpg_det(char*);
 void atpg(char *);
 void podem(char*);
 void dalg(char*);
-void dfs(char*);
+void limit(char*);
 void exit(char*);
 
-void podemATPGReport(double fc, double time, inputSet* testVectors);
+bool atpgOption(const char* cp, const char* name);
+double atpgLearn(const char* cp);
+void podemATPGReport(const char* alg, double fc, double time, PatternStore* testVectors, double learnTime);
 
 enum e_state {EXEC, CKTLD};         /* Gstate values */
 
@@ -45,14 +49,17 @@ struct cmdstruc command[NUMFUNCS] = {
 	{"LEV", lev, CKTLD},
 	{"LOGICSIM", logicSim, CKTLD},
 	{"RFL", rfl, CKTLD},
-	{"DFS", dfs, CKTLD},
+	{"DFS", multi_dfs, CKTLD},
 	{"PRINTNODE", printNode, CKTLD},
 	{"PFS", pfs, CKTLD},
+	{"CFS", cfs, CKTLD},
+	{"CPT", cpt, CKTLD},
 	{"RTG", rtg,CKTLD},
     {"PODEM", podem, CKTLD},
     {"DALG", dalg, CKTLD},
     {"ATPG_DET", atpg_det, EXEC},
     {"ATPG", atpg, EXEC},
+    {"LIMIT", limit, EXEC},
 	{"EXIT", exit, EXEC},
 	//{"WRITEALLFAULTS", writeAllFaults, CKTLD},
 };
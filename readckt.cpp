@@ -47,7 +47,6 @@ char currentCircuit[MAXNAME];			/* Name of current circuit ex: "c17" */
 
 int debugMode = 0;  // 0, 1, or 2; different messaging options to print to console
 
-int dfs_count = 1;
 vector<NSTRUC> NodeV;
 vector<int> PI_Nodes;
 vector<int> PO_Nodes;
@@ -55,12 +54,13 @@ vector<int> index2ref;
 vector<int> ref2index;
 
 //  DFS variables
-map<int, vector<int> > dfs_fault_list;
-//map<int, int> fault_vals, previous_logic;
-map<int, int> fault_vals;
-vector<int> final, prevLogic;
-vector<string> file_output;
-vector<int> reVisit;
+//  Fault list rows, bitsets over fault IDs 2*index + stuck-at (see dfsInit)
+vector<uint64_t> dfs_fault_list;
+int dfsWords;
+vector<int> dfsLo, dfsHi;					//  populated word range of each row
+vector<char> dfsLogic;						//  good logic 0, 1, 2 = X
+vector<uint64_t> dfsDetected;				//  faults already found at a PO
+vector< pair<int,int> > dfsOrder;			//  First->level, second->node index
 
 //  Logic Simulation
 vector<int> PI_list;
@@ -70,11 +70,24 @@ vector<vector<char> > inputPatterns;
 // D Algorithm
 set<int> D_frontier;
 set<int> J_frontier;
+vector<TSTRUC> trail_Dalg;				//  changes since setup, see saveState_Dalg
 vector< pair<int,int> > nodeQueueForward; //  First->level, second->node reference
 vector< pair<int,int> > nodeQueueBackward; //  First->level, second->node reference
 int faultyNode_Dalg;
 bool stuckAt_Dalg;
+Implications *learned_Dalg = NULL;		//  static learning table; NULL when not used
+Dominators *dominators_Dalg = NULL;		//  PO-dominator tree; NULL when not available
+bool siteSensitized_Dalg;				//  fault site dominator inputs assigned
+Compactor *compactor_Dalg = NULL;		//  static compaction; NULL when not available
+vector<char> faultCone_Dalg;			//  fanout cone of the fault, by netlist index
+double learnTime_Dalg = -1;
 int cycleCounter = 0;
+int backtrackLimit_Dalg = MAXBACKTRACK;	//  per fault, 0 for no limit
+double timeLimit_Dalg = MAXFAULTTIME;	//  seconds per fault, 0 for no limit
+int backtracks_Dalg = 0;
+bool aborted_Dalg = false;				//  a limit was hit on the current fault
+struct timeval faultStart_Dalg;
+ATPGSTATS stats_Dalg;
 
 
 
@@ -86,6 +99,15 @@ bool eventDriven = true;
 vector<FSTRUC> FaultV;
 vector<FSTRUC> FaultV_Dropped;
 
+//  Concurrent Fault Simulation
+vector<unsigned char> cfsGood;			//  good machine logic per node
+vector<vector<CFREC> > cfsList;			//  diverging faulty machines, sorted by fault
+vector<vector<int> > cfsLocal;			//  faults located at each node, sorted
+vector<vector<int> > cfsQueue;			//  pending nodes, by level
+vector<char> cfsQueued;
+vector<char> cfsDropped;
+vector<int> cfsFoundIn;					//  last pattern recorded per fault
+
 //  Varible to store PO outputs
 vector<vector<char> > outputPatterns;
 
@@ -125,6 +147,8 @@ void ATPG_DET(char *cp){
 	
 	//  Create the reduced fault list
 	reducedFL();
+	clearStats(stats_Dalg);
+	stats_Dalg.total = FaultV.size();
 	
 	// Clear out input pattern vector
 	inputPatterns.clear();
@@ -153,17 +177,24 @@ void ATPG_DET(char *cp){
 		//  Run D Algorithm
 		bool success_dalg;
 		success_dalg = D_algorithm();
+		addBacktracks(stats_Dalg, backtracks_Dalg);
 	
 		//  Print message to console
 		if(!success_dalg){
+			if(aborted_Dalg){
+				stats_Dalg.aborted++;
+			}else{
+				stats_Dalg.redundant++;
+			}
 			if(debugMode>0){
-				printf("  Failed D Algorithm ***************\n");
+				printf("  Failed D Algorithm%s ***************\n", aborted_Dalg ? " (aborted)" : "");
 			}
 		
 		}else{
 			if(debugMode>0){
 				printf("  Completed D Algorithm\n");
 			}
+			stats_Dalg.detected++;
 			FaultV[i].faultFound.push_back(i);
 			
 			//Save PI patterns to "inputPatterns" vector
@@ -171,6 +202,9 @@ void ATPG_DET(char *cp){
 		}
 	}//  End loop for each fault
 	
+	//  Drop the patterns other patterns make unnecessary
+	compactPatterns_Dalg();
+	
 	//  Write file of input patterns
 	char filename[MAXLINE];
 	sprintf(filename,"%s_%s_ATPG_patterns.txt",currentCircuit, algType);
@@ -195,6 +229,7 @@ void ATPG_DET(char *cp){
 }
 
 void addInputPattern_Dalg(void){
+	//  A faulty PI holds D or Dbar; the pattern applies its good value
 	NSTRUC *np;
 	vector<char> tempPattern;
 	for(int i=0;i<PI_Nodes.size();++i){
@@ -202,9 +237,11 @@ void addInputPattern_Dalg(void){
 		
 		switch(np->logic5){
 			case zero:
+			case dbar:
 				tempPattern.push_back('0');
 				break;
 			case one:
+			case d:
 				tempPattern.push_back('1');
 				break;
 			default:
@@ -215,6 +252,78 @@ void addInputPattern_Dalg(void){
 	
 }
 
+void setInputPatterns(inputList &tests){
+	//  Replaces "inputPatterns" with the given vectors, in "PI_Nodes"
+	//  order, for writeInputPatterns
+	inputPatterns.assign(tests.size(), vector<char>(PI_Nodes.size(), 'X'));
+	for(int patt=0;patt<tests.size();++patt){
+		for(int i=0;i<PI_Nodes.size();++i){
+			inputMap::iterator it = tests[patt]->find(PI_Nodes[i]);
+			if(it == tests[patt]->end()){
+				continue;
+			}
+			if(it->second == ZERO){
+				inputPatterns[patt][i] = '0';
+			}else if(it->second == ONE){
+				inputPatterns[patt][i] = '1';
+			}
+		}
+	}
+}
+
+
+void compactPatterns_Dalg(void){
+	//  Static compaction of "inputPatterns" over the fault list; each
+	//  fault some pattern detects is still detected by the ones kept.
+	//  Cubes are first merged into earlier ones they agree with on every
+	//  PI both assign, which also drops duplicates.
+	if(compactor_Dalg == NULL || inputPatterns.size() == 0){
+		return;
+	}
+	Netlist *nl = compactor_Dalg->getNetlist();
+	PatternStore tests(PI_Nodes);
+	inputMap test;
+	for(int patt=0;patt<inputPatterns.size();++patt){
+		test.clear();
+		for(int i=0;i<PI_Nodes.size();++i){
+			switch(inputPatterns[patt][i]){
+				case '0':
+					test[PI_Nodes[i]] = ZERO;
+					break;
+				case '1':
+					test[PI_Nodes[i]] = ONE;
+					break;
+				default:
+					test[PI_Nodes[i]] = X;
+			}
+		}
+		tests.addCompatible(test);
+	}
+	vector< pair<int,int> > faults;
+	for(int i=0;i<FaultV.size();++i){
+		faults.push_back(make_pair(nl->getIndex(FaultV[i].ref), FaultV[i].stuckAt ? 1 : 0));
+	}
+	
+	vector<int> keep = compactor_Dalg->compact(tests, faults);
+	printf("Static compaction kept %d of %d patterns\n", (int)keep.size(), (int)inputPatterns.size());
+	tests.keep(keep);
+	inputPatterns.assign(tests.size(), vector<char>(PI_Nodes.size(), 'X'));
+	for(int patt=0;patt<tests.size();++patt){
+		for(int i=0;i<PI_Nodes.size();++i){
+			switch(tests.getValue(patt, tests.findPI(PI_Nodes[i]))){
+				case ZERO:
+					inputPatterns[patt][i] = '0';
+					break;
+				case ONE:
+					inputPatterns[patt][i] = '1';
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
+
 
 /*------------------------------------------------------------*/
 /*------  D-Algorithm  ---------------------------------------*/
@@ -309,6 +418,7 @@ bool setup_Dalg(void){
 	//  Reset frontier arrays
 	D_frontier.clear();
 	J_frontier.clear();
+	trail_Dalg.clear();
 	resetNodes_Dalg();
 	
 	//  Assign Fault
@@ -330,7 +440,25 @@ bool setup_Dalg(void){
 	addNodeToQueue(nodeQueueForward, faultyNode_Dalg);
 	addNodeToQueue(nodeQueueBackward, faultyNode_Dalg);
 	
+	//  Mark the fault cone; dominator inputs in it may carry the error
+	if(dominators_Dalg != NULL){
+		Netlist *nl = dominators_Dalg->getNetlist();
+		int site = nl->getIndex(faultyNode_Dalg);
+		faultCone_Dalg.assign(nl->getNumNodes(), 0);
+		faultCone_Dalg[site] = 1;
+		for(int idx=site+1;idx<nl->getNumNodes();++idx){
+			const int *in = nl->getFanIns(idx);
+			for(int j=0;j<nl->getNumFanIns(idx)&&!faultCone_Dalg[idx];++j){
+				faultCone_Dalg[idx] = faultCone_Dalg[in[j]];
+			}
+		}
+	}
+	
 	cycleCounter = 0;
+	siteSensitized_Dalg = false;
+	backtracks_Dalg = 0;
+	aborted_Dalg = false;
+	gettimeofday(&faultStart_Dalg, 0);
 	
 	return true;
 	
@@ -342,19 +470,17 @@ bool D_algorithm(void){
 	set<int> tryList;
 	set<int>::iterator Dptr, Jptr;
 	int nodeD, nodeJ;
-	//  Placeholders for current circuit state in case backtracking is needed
-	set<int> J_front_save;
-	set<int> D_front_save;
-	vector< pair<int,enum e_logicType> > logicState;
+	//  Trail position to return to in case backtracking is needed
+	int mark;
 	
 	++cycleCounter; 
 	if(debugMode>1){
 		
 		printf("Starting Recursive D Algorithm, pass %d\n", cycleCounter);
 	}
-	if(cycleCounter>(NodeV.size())){
+	if(limitReached_Dalg()){
 		if(debugMode>1){
-			printf("Failure; exceeded cycle limit for the recursive D algorithm; %d cycles\n", cycleCounter);
+			printf("Failure; aborted after %d backtracks\n", backtracks_Dalg);
 		}
 		return false;
 	}
@@ -377,6 +503,18 @@ bool D_algorithm(void){
 			}
 			return false;
 		}
+		//  Once the fault settles, and before the first decision, add
+		//  the values unique sensitization of the fault site requires
+		if((cycleCounter==1)&&(dominators_Dalg!=NULL)&&(nodeQueueForward.size()==0)&&(nodeQueueBackward.size()==0)&&!siteSensitized_Dalg){
+			siteSensitized_Dalg = true;
+			success = sensitizeDominators_Dalg(dominators_Dalg->getNetlist()->getIndex(faultyNode_Dalg), true);
+			if(!success){
+				if(debugMode>1){
+					printf("Failed unique sensitization\n");
+				}
+				return false;
+			}
+		}
 	}
 	
 	if(debugMode>1){
@@ -406,6 +544,12 @@ bool D_algorithm(void){
 			}
 			return false;
 		}
+		if(!dominatorCheck_Dalg()){
+			if(debugMode>1){
+				printf("Failed unique sensitization\n");
+			}
+			return false;
+		}
 		//  Try each node in the D-frontier
 		tryList.clear();
 		//  Try each node in the D frontier		
@@ -421,7 +565,7 @@ bool D_algorithm(void){
 				//  This node has not been tried yet
 				tryList.insert(nodeD);
 				//  Save this current state in case backtracking is needed
-				saveState_Dalg(J_front_save, D_front_save, logicState);
+				mark = saveState_Dalg();
 				//  Set inputs to propogate D
 				//  Also adds nodes to the process queue
 				propogate_Dfrontier_Dalg(nodeD, true);
@@ -433,7 +577,10 @@ bool D_algorithm(void){
 					if(debugMode>1){
 						printf("Failed propogate D frontier at node %d; backtracking\n", nodeD);
 					}
-					reloadState_Dalg(J_front_save, D_front_save, logicState);
+					reloadState_Dalg(mark);
+					if(aborted_Dalg){
+						return false;
+					}
 					//  Special case for XOR; need to try other condition
 					//  Set inputs to propogate D
 					propogate_Dfrontier_Dalg(nodeD, false);
@@ -445,7 +592,10 @@ bool D_algorithm(void){
 							printf("Failed propogate D frontier at node %d with alt XOR; backtracking\n", nodeD);
 						}
 						
-						reloadState_Dalg(J_front_save, D_front_save, logicState);
+						reloadState_Dalg(mark);
+						if(aborted_Dalg){
+							return false;
+						}
 					}
 				}
 				Dptr = D_frontier.begin();
@@ -484,9 +634,9 @@ bool D_algorithm(void){
 			//  This node has not been tried yet
 			tryList.insert(nodeJ);
 			
-			while(nInputsX_Dalg(nodeJ)>0){
+			if(nInputsX_Dalg(nodeJ)>0){
 				//  Save this current state in case backtracking is needed
-				saveState_Dalg(J_front_save, D_front_save, logicState);
+				mark = saveState_Dalg();
 				//  Set inputs to backwards propogate J
 				//  Also adds nodes to the process queue
 				int gateRef = propogate_Jfrontier_Dalg(nodeJ, -1);
@@ -499,9 +649,14 @@ bool D_algorithm(void){
 						printf("Failed propogate J frontier at node %d; backtracking\n", nodeJ);
 					}
 					
-					reloadState_Dalg(J_front_save, D_front_save, logicState);				
+					reloadState_Dalg(mark);				
+					if(aborted_Dalg){
+						return false;
+					}
+					//  The input takes the other value; it has to be
+					//  implied before anything else is decided
 					propogate_Jfrontier_Dalg(nodeJ, gateRef);
-					
+					return D_algorithm();
 				}
 							
 			}
@@ -581,7 +736,7 @@ int propogate_Jfrontier_Dalg(int nodeRef, int gateRef){
 	
 	//  Set logic of this upstream node and add to queue to process
 	npUp = getNodePtr(np->upNodes[gateToSet]);
-	npUp->logic5 = logicSet;
+	setLogic_Dalg(npUp, logicSet);
 	if(debugMode>1){
 		printf("Adding node %d to backward queue\n", npUp->ref);
 		printf("Adding node %d to backward queue\n", np->ref); 
@@ -613,18 +768,18 @@ void propogate_Dfrontier_Dalg(int nodeRef, bool XOR_version){
 			switch (np->gateType){
 				case AND:
 				case NAND:
-					npUp->logic5 = one;
+					setLogic_Dalg(npUp, one);
 					break;
 				case OR:
 				case NOR:
-					npUp->logic5 = zero;
+					setLogic_Dalg(npUp, zero);
 					break;
 				case XOR:
 				case XNOR:
 					if(XOR_version){
-						npUp->logic5 = one;
+						setLogic_Dalg(npUp, one);
 					}else{
-						npUp->logic5 = zero;
+						setLogic_Dalg(npUp, zero);
 					}
 					break;
 				default:
@@ -693,10 +848,14 @@ bool forwardImply_Dalg(void){
 				printf("Adding node %d to D frontier",nodeRef);
 			}
 			
-			D_frontier.insert(nodeRef);
+			frontierInsert_Dalg(D_frontier, nodeRef);
 		}else{
-			//  Erase this node if it's already in the D frontier
-			D_frontier.erase(nodeRef);
+			//  Erase this node if it's already in the D frontier, and
+			//  from the J frontier once its inputs justify its value
+			frontierErase_Dalg(D_frontier, nodeRef);
+			if(newLogic!=x){
+				frontierErase_Dalg(J_frontier, nodeRef);
+			}
 			//  Propogate new value forward
 			//  Only propogate if the logic has changed or this is the faulty node
 			
@@ -705,7 +864,13 @@ bool forwardImply_Dalg(void){
 					if(debugMode>1){
 						printf("Node %d, logic change from %s to %s\n", np->ref, logicname(np->logic5), logicname(newLogic));
 					}
-					np->logic5 = newLogic;
+					setLogic_Dalg(np, newLogic);
+				}
+				if(!learnedCheck_Dalg(np->ref)){
+					if(debugMode>1){
+						printf("Failed Forward Imply; node %d, learned implication conflict\n", np->ref);
+					}
+					return false;
 				}
 				
 				
@@ -744,6 +909,13 @@ bool backwardsImply_Dalg(void){
 			printNode_Dalg(nodeRef);
 		}
 		
+		if(!learnedCheck_Dalg(nodeRef)){
+			if(debugMode>1){
+				printf("Failed Backwards Imply; node %d, learned implication conflict\n", nodeRef);
+			}
+			return false;
+		}
+		
 		
 		//  No need to process anything, go to next node
 		if(np->nodeType==PI){
@@ -778,7 +950,7 @@ bool backwardsImply_Dalg(void){
 		
 		//  Main logic function
 		vector<int> inputChangedList;
-		bool isOK;
+		bool isOK = true;
 		
 		if(newLogic!=np->logic5){
 			//  Gate needs to be evaluated; output changed
@@ -807,6 +979,7 @@ bool backwardsImply_Dalg(void){
 			if(debugMode>1){
 				printf("Failed to backwards propogate node %d; logical error\n", np->ref);
 			}
+			return false;
 		}
 		
 		//
@@ -816,7 +989,7 @@ bool backwardsImply_Dalg(void){
 			if(debugMode>1){
 				printf("  Found new J-frontier, node %d\n", nodeRef);
 			}
-			J_frontier.insert(nodeRef);
+			frontierInsert_Dalg(J_frontier, nodeRef);
 			if(np->gateType == NOT){
 				printf("NOT gate added to J frontier\n");
 				return false;
@@ -825,7 +998,7 @@ bool backwardsImply_Dalg(void){
 		}else{
 			// This node is not a J-frontier; continue upstream
 			//  Erase this from the J_frontier in case it is there
-			J_frontier.erase(nodeRef);
+			frontierErase_Dalg(J_frontier, nodeRef);
 			//  Push all the downstream nodes to the queue
 			if(debugMode>1){
 				printf("  Not a J frontier; adding nodes to backward queue:\n", nodeRef);
@@ -875,7 +1048,7 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList){
 	//  Easy solution for single input buffer or NOT gate
 	if(np->upNodes.size()==1){
 		npUp = getNodePtr(np->upNodes[0]);
-		npUp->logic5 = logEval;
+		setLogic_Dalg(npUp, logEval);
 		if(debugMode>1){
 			printf("Applying logic, Node: %d = %s\n", npUp->ref, logicname(npUp->logic5));
 		}
@@ -909,11 +1082,14 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList){
 			for(int i=0;i<np->upNodes.size();i++){
 				npUp = getNodePtr(np->upNodes[i]);
 				if(npUp->logic5 == x){
-					npUp->logic5 = one;
+					setLogic_Dalg(npUp, one);
 					if(debugMode>1){
 						printf("Applying logic, Node: %d = %s\n", npUp->ref, logicname(npUp->logic5));
 					}
 					inputChangedList.push_back(npUp->ref);
+				}else if(npUp->logic5 != one){
+					//  A 0, D or Dbar input cannot give this output
+					return false;
 				}
 				
 			}
@@ -924,7 +1100,7 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList){
 			for(int i=0;i<np->upNodes.size();i++){
 				npUp = getNodePtr(np->upNodes[i]);
 				if(npUp->logic5 == x){
-					npUp->logic5 = zero;
+					setLogic_Dalg(npUp, zero);
 					if(debugMode>1){
 						printf("Applying logic, Node: %d = %s\n", npUp->ref, logicname(npUp->logic5));
 					}
@@ -947,11 +1123,14 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList){
 			for(int i=0;i<np->upNodes.size();i++){
 				npUp = getNodePtr(np->upNodes[i]);
 				if(npUp->logic5 == x){
-					npUp->logic5 = zero;
+					setLogic_Dalg(npUp, zero);
 					if(debugMode>1){
 						printf("Applying logic, Node: %d = %s\n", npUp->ref, logicname(npUp->logic5));
 					}
 					inputChangedList.push_back(npUp->ref);
+				}else if(npUp->logic5 != zero){
+					//  A 1, D or Dbar input cannot give this output
+					return false;
 				}
 			}
 		}else if(nX==1){
@@ -961,7 +1140,7 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList){
 			for(int i=0;i<np->upNodes.size();i++){
 				npUp = getNodePtr(np->upNodes[i]);
 				if(npUp->logic5 == x){
-					npUp->logic5 = one;
+					setLogic_Dalg(npUp, one);
 					if(debugMode>1){
 						printf("Applying logic, Node: %d = %s\n", npUp->ref, logicname(npUp->logic5));
 					}
@@ -991,9 +1170,9 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList){
 					return false;
 				}
 				if(logEval == zero){
-					np1->logic5 = np2->logic5;
+					setLogic_Dalg(np1, np2->logic5);
 				}else{
-					np1->logic5 = NOT_LOGIC5[np2->logic5];
+					setLogic_Dalg(np1, NOT_LOGIC5[np2->logic5]);
 				}
 				if(debugMode>1){
 					printf("Applying logic, Node: %d = %s\n", np1->ref, logicname(np1->logic5));
@@ -1005,9 +1184,9 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList){
 					return false;
 				}
 				if(logEval == zero){
-					np2->logic5 = np1->logic5;
+					setLogic_Dalg(np2, np1->logic5);
 				}else{
-					np2->logic5 = NOT_LOGIC5[np1->logic5];
+					setLogic_Dalg(np2, NOT_LOGIC5[np1->logic5]);
 				}
 				
 				if(debugMode>1){
@@ -1181,7 +1360,7 @@ void branchPropogate_Dalg(int ref_B,enum e_logicType setLogic,  int origin){
 			setLogic = zero;
 		}
 	}else{
-		np->logic5 = setLogic;
+		setLogic_Dalg(np, setLogic);
 		if(debugMode>1){
 			printf("  Node %d logic set to %s\n", np->ref, logicname(np->logic5));
 		}
@@ -1224,60 +1403,195 @@ void branchPropogate_Dalg(int ref_B,enum e_logicType setLogic,  int origin){
 	}
 }
 
-void saveState_Dalg(set<int>& J_front_save, set<int>& D_front_save, vector< pair<int,enum e_logicType> >& logicState){
-	//  Save the current state of the circuit analysis
+int saveState_Dalg(void){
+	//  Marks the current state of the circuit analysis
 	//  For use in case back-tracking is needed
 	//  No need to save the node queues; should already be empty
-	set<int>::iterator setIter;
+	return trail_Dalg.size();
+}
+
+void reloadState_Dalg(int mark){
+	//  Returns the circuit analysis to the state saved at mark by undoing
+	//  the trail, so a backtrack costs only the changes made since then
+	NSTRUC *np;
+	while(trail_Dalg.size()>mark){
+		TSTRUC &t = trail_Dalg.back();
+		switch(t.type){
+			case TRAIL_LOGIC:
+				np = getNodePtr(t.ref);
+				np->logic5 = t.logic5;
+				break;
+			case TRAIL_D_ADD:
+				D_frontier.erase(t.ref);
+				break;
+			case TRAIL_D_ERASE:
+				D_frontier.insert(t.ref);
+				break;
+			case TRAIL_J_ADD:
+				J_frontier.erase(t.ref);
+				break;
+			case TRAIL_J_ERASE:
+				J_frontier.insert(t.ref);
+				break;
+		}
+		trail_Dalg.pop_back();
+	}
+	//  Ensure node processing queues are empty
+	nodeQueueForward.clear();
+	nodeQueueBackward.clear();
 	
-	//   Save the J frontier and D frontier
-	J_front_save.clear();
-	D_front_save.clear();
-	for(setIter = J_frontier.begin();setIter!=J_frontier.end();++setIter){
-		J_front_save.insert(*setIter);
+	//  Every reload undoes a failed decision, except while unwinding
+	//  after an abort
+	if(!aborted_Dalg){
+		++backtracks_Dalg;
 	}
-	for(setIter = D_frontier.begin();setIter!=D_frontier.end();++setIter){
-		D_front_save.insert(*setIter);
+}
+
+void setLogic_Dalg(NSTRUC *np, enum e_logicType logic){
+	//  Assigns a node value, keeping the old one on the trail
+	if(np->logic5 == logic){
+		return;
 	}
-	
-	//  Save the logic states
-	logicState.clear();
-	NSTRUC *np;
-	for(int i=0;i<NodeV.size();++i){
-		np = &NodeV[i];
-		logicState.push_back(make_pair(np->ref, np->logic5));
+	TSTRUC t = {TRAIL_LOGIC, np->ref, np->logic5};
+	trail_Dalg.push_back(t);
+	np->logic5 = logic;
+}
+
+void frontierInsert_Dalg(set<int>& frontier, int nodeRef){
+	//  Adds a node to the D or J frontier, recording it on the trail
+	if(frontier.insert(nodeRef).second){
+		TSTRUC t = {&frontier == &D_frontier ? TRAIL_D_ADD : TRAIL_J_ADD, nodeRef, x};
+		trail_Dalg.push_back(t);
 	}
 }
 
-void reloadState_Dalg(set<int>& J_front_save, set<int>& D_front_save, vector< pair<int,enum e_logicType> >& logicState){
-	//  Reload the current state of the circuit analysis
-	//  For use in case back-tracking is needed
-	//  No need to reload the node queues; should already be empty
-	
-	set<int>::iterator setIter;
-	J_frontier.clear();
-	D_frontier.clear();
-	for(setIter = J_front_save.begin();setIter!=J_front_save.end();++setIter){
-		J_frontier.insert(*setIter);
+void frontierErase_Dalg(set<int>& frontier, int nodeRef){
+	//  Removes a node from the D or J frontier, recording it on the trail
+	if(frontier.erase(nodeRef)>0){
+		TSTRUC t = {&frontier == &D_frontier ? TRAIL_D_ERASE : TRAIL_J_ERASE, nodeRef, x};
+		trail_Dalg.push_back(t);
 	}
-	for(setIter = D_front_save.begin();setIter!=D_front_save.end();++setIter){
-		D_frontier.insert(*setIter);
+}
+
+bool limitReached_Dalg(void){
+	//  True once the current fault has used up its backtrack or time
+	//  budget; the fault is then aborted rather than redundant
+	if(aborted_Dalg){
+		return true;
 	}
-	
-	//  Reload the logic states
-	NSTRUC *np;
-	for(int i=0;i<logicState.size();++i){
-		np = getNodePtr(logicState[i].first);
-		np->logic5 = logicState[i].second;
+	if(backtrackLimit_Dalg>0 && backtracks_Dalg>backtrackLimit_Dalg){
+		aborted_Dalg = true;
 	}
-	//  Ensure node processing queues are empty
-	nodeQueueForward.clear();
-	nodeQueueBackward.clear();
+	if(timeLimit_Dalg>0){
+		struct timeval now;
+		gettimeofday(&now, 0);
+		double elapsed = (now.tv_sec - faultStart_Dalg.tv_sec) + (now.tv_usec - faultStart_Dalg.tv_usec)*1e-6;
+		if(elapsed>timeLimit_Dalg){
+			aborted_Dalg = true;
+		}
+	}
+	return aborted_Dalg;
 }
 
 
 
 
+int goodValue_Dalg(enum e_logicType logic){
+	//  Fault free value of a 5-value logic; -1 for x
+	switch(logic){
+		case zero:
+		case dbar:
+			return 0;
+		case one:
+		case d:
+			return 1;
+		default:
+			return -1;
+	}
+}
+
+bool learnedCheck_Dalg(int nodeRef){
+	//  Checks the implications learned for this node's fault free value
+	//  against the current values.  Only conflicts are reported; no
+	//  values are assigned since an implied node may lie in the fault cone.
+	//  Returns false on a conflict
+	if(learned_Dalg == NULL){
+		return true;
+	}
+	NSTRUC *np = getNodePtr(nodeRef);
+	int v = goodValue_Dalg(np->logic5);
+	if(v<0){
+		return true;
+	}
+	Netlist *nl = learned_Dalg->getNetlist();
+	int idx = nl->getIndex(nodeRef);
+	const int *implied = learned_Dalg->getImplied(idx, v);
+	for(int i=0;i<learned_Dalg->getNumImplied(idx, v);++i){
+		NSTRUC *npImp = getNodePtr(nl->getNodeID(Implications::litNode(implied[i])));
+		int w = goodValue_Dalg(npImp->logic5);
+		if((w>=0)&&(w!=Implications::litValue(implied[i]))){
+			return false;
+		}
+	}
+	return true;
+}
+
+bool dominatorCheck_Dalg(void){
+	//  With a single gate in the D-frontier the error has to pass every
+	//  dominator of that gate.  Returns false if a side input of one of
+	//  them already holds the controlling value
+	if((dominators_Dalg == NULL)||(D_frontier.size()!=1)){
+		return true;
+	}
+	Netlist *nl = dominators_Dalg->getNetlist();
+	return sensitizeDominators_Dalg(nl->getIndex(*D_frontier.begin()), false);
+}
+
+bool sensitizeDominators_Dalg(int idx, bool assign){
+	//  The side inputs of each dominator of netlist node idx need the
+	//  non-controlling value.  With assign set, the X ones get it and are
+	//  queued for implication.  Returns false if a side input holds the
+	//  controlling value
+	Netlist *nl = dominators_Dalg->getNetlist();
+	for(int dom=dominators_Dalg->getIdom(idx);dom!=DOM_ROOT;dom=dominators_Dalg->getIdom(dom)){
+		enum e_logicType ncv;
+		switch(nl->getGateType(dom)){
+			case AND:
+			case NAND:
+				ncv = one;
+				break;
+			case OR:
+			case NOR:
+				ncv = zero;
+				break;
+			default:
+				continue;
+		}
+		const int *in = nl->getFanIns(dom);
+		for(int j=0;j<nl->getNumFanIns(dom);++j){
+			if(faultCone_Dalg[in[j]]){
+				continue;
+			}
+			NSTRUC *npIn = getNodePtr(nl->getNodeID(in[j]));
+			if(npIn->logic5==x){
+				if(!assign){
+					continue;
+				}
+				setLogic_Dalg(npIn, ncv);
+				if(debugMode>1){
+					printf("Unique sensitization\n   Dominator %d assigning %s to upstream node %d\n",
+						nl->getNodeID(dom), logicname(ncv), npIn->ref);
+				}
+				addNodeToQueue(nodeQueueBackward, npIn->ref);
+				addNodeToQueue(nodeQueueForward, nl->getNodeID(dom));
+			}else if(npIn->logic5!=ncv){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 int faultAtPO_Dalg(void){
 	//  Determine if error is at PO
 	NSTRUC *np;
@@ -1424,7 +1738,33 @@ void parallelFS(char *cp)
 	
 }
 
+int parallelWordBits(void){
+	//  Widest word type for PFS/PLS supported by this CPU
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2")){
+		return 256;
+	}
+	if(__builtin_cpu_supports("sse2")){
+		return 128;
+	}
+	return 64;
+}
+
 void parallelFaultSimulation(void){
+	//  Dispatch to the widest word type the CPU supports
+	switch(parallelWordBits()){
+		case 256:
+			parallelFaultSimulation<word256_t>();
+			break;
+		case 128:
+			parallelFaultSimulation<word128_t>();
+			break;
+		default:
+			parallelFaultSimulation<uint64_t>();
+	}
+}
+
+template<typename W> void parallelFaultSimulation(void){
 	//  Perform fault simulation
 	//  Assumes the following are already populated correctly:
 	//		"PI_list"
@@ -1435,47 +1775,349 @@ void parallelFaultSimulation(void){
 	eventDriven = false;
 	
 	//  Determine the # of passes to simulate all faults
-	//  Can only do (32 or 64 -1) faults
+	//  Can only do (word width -1) faults
 	//  first entry is always "no fault"
-	int N_passes, N_faults, faults;
-	int indStart, indEnd;
-	N_faults = FaultV.size();
-	N_passes = intCeil(N_faults, bitWidth-1);// Ceil function, A/B
+	int N_passes = intCeil(FaultV.size(), wordBits<W>()-1);// Ceil function, A/B
 	
-	// Debug Printout //////////////////
-	//printf("\n %d input patterns, %d Faults\n", inputPatterns.size(),N_faults);
-	/////////////////////////////
-	for(int patt = 0;patt<inputPatterns.size();++patt){
+	//  Each pass (fault group) is simulated for all patterns by one
+	//  worker. Workers take passes from a shared counter and own their
+	//  node state and queue; a fault is only ever touched by the worker
+	//  holding its pass, so "faultFound" is written without locks.
+	atomic<int> nextPass(0);
+	int N_threads = min(pfsThreads(), N_passes);
+	vector<thread> workers;
+	for(int t = 1;t<N_threads;++t){
+		workers.push_back(thread(pfsWorker<W>, &nextPass));
+	}
+	pfsWorker<W>(&nextPass);
+	for(int t = 0;t<workers.size();++t){
+		workers[t].join();
+	}
+}
+
+template<typename W> void pfsWorker(atomic<int> *nextPass){
+	int width = wordBits<W>();
+	int N_faults = FaultV.size();
+	int N_passes = intCeil(N_faults, width-1);
+	int indStart, indEnd;
+	vector<PSTRUC<W> > ps;
+	vector< pair<int,int> > queue;
+	initParallelState(ps);
+	
+	for(int pass = (*nextPass)++;pass<N_passes;pass = (*nextPass)++){
+		//  Find start and stop indexes in fault list for this pass
+		indStart = pass*(width-1);
+		indEnd = (pass+1)*(width-1)-1;
+		indEnd = min(indEnd, (N_faults-1));
 		
-		for(int pass = 0;pass<N_passes;++pass){
-			//  Find start and stop indexes in fault list for this pass
-			indStart = pass*(bitWidth-1);
-			indEnd = (pass+1)*(bitWidth-1)-1;
-			indEnd = min(indEnd, (N_faults-1));
-			//Debug ////////////////////
-			//printf("Pass %d; Fault list start: %d, end: %d, total: %d\n",pass, indStart, indEnd, FaultV.size());
-			///////////////////////////////
-			
+		// Set all fault masks to known value
+		setFaults(ps, indStart, indEnd);
+		
+		for(int patt = 0;patt<inputPatterns.size();++patt){
 			//  Set input pattern at PI's
-			setPI_forPFS(patt);
-			// Set all fault masks to known value
-			setFaults(indStart, indEnd);
+			setPI_forPFS(ps, patt);
 			
 			//  Add PI list to queue
-			addPiNodesToQueue();
+			addPiNodesToQueue(queue);
 			
 			// Simulate Circuit Logic
 			// Process the Node queue; simulates logic of each node
-			processNodeQueue();
+			processNodeQueue(ps, queue);
 			
 			//  Check Results
 			//  Records if faults are found
-			checkFaults(indStart, indEnd, patt);
-		}			
+			checkFaults(ps, indStart, indEnd, patt);
+		}
+	}
+}
+
+int pfsThreads(void){
+	//  Number of PFS workers; PFS_THREADS overrides the core count
+	char *env = getenv("PFS_THREADS");
+	if((env != NULL)&&(atoi(env) > 0)){
+		return atoi(env);
+	}
+	int n = thread::hardware_concurrency();
+	return (n > 0) ? n : 1;
+}
+
+/*----------------------------------------------------*/
+/*------Concurrent Fault Simulation -----------------*/
+/*----------------------------------------------------*/
+void concurrentFS(char *cp)
+{
+	//  Concurrent fault simulation wrapper
+	//  Same inputs and report as parallelFS
+	char patternFile[MAXLINE];
+	char faultFile[MAXLINE];
+	char outFile[MAXLINE];
+	bool fileOK;
+	
+	//  Read in file names
+	sscanf(cp, "%s %s %s", patternFile, faultFile, outFile);
+	//Debug //////////
+	printf("\nConcurrent Fault Simulation\n");
+	printf("Test Patterns: %s\n",patternFile);
+	printf("Fault List: %s\n", faultFile);
+	printf("Output: %s;\n", outFile);
+	////////////////////////////////////
+	
+	//  Read Fault List
+	//    Populates "FaultV"
+	fileOK = readFaultList(faultFile);
+	if(!fileOK){return;}
+	
+	//  Read Test Patterns
+	fileOK = rtp(patternFile);
+	if(!fileOK){return;}
+	
+	//  Perform fault simulation
+	concurrentFaultSimulation();
+	
+	//  Done; write report
+	writeFaultsDetected(outFile);
+	
+	//  Print "OK"
+	printf("\n==> OK\n");
+}
+
+void concurrentFaultSimulation(void){
+	//  Perform fault simulation
+	//  Assumes the following are already populated correctly:
+	//		"PI_list"
+	//		"inputPatterns"
+	//		"FaultV"
+	//  Every node keeps its good logic and a list of the faulty machines
+	//  whose logic differs there. A node is only re-evaluated when the
+	//  good logic or the faulty list of one of its inputs changed, and
+	//  then only the faults in the input lists are evaluated.
+	//  Faults are dropped after N_DROP detections, so "faultFound"
+	//  holds at most N_DROP patterns.
+	int i, f;
+	int N = NodeV.size();
+	int maxLevel = 0;
+	for(i = 0;i<N;++i){
+		maxLevel = max(maxLevel, NodeV[i].level);
+	}
+	
+	cfsGood.assign(N, CFS_X);
+	cfsList.assign(N, vector<CFREC>());
+	cfsLocal.assign(N, vector<int>());
+	cfsQueue.assign(maxLevel+1, vector<int>());
+	cfsQueued.assign(N, 0);
+	cfsDropped.assign(FaultV.size(), 0);
+	cfsFoundIn.assign(FaultV.size(), -1);
+	for(f = 0;f<FaultV.size();++f){
+		cfsLocal[ref2index[FaultV[f].ref]].push_back(f);
+		if(FaultV[f].faultFound.size()>=N_DROP){
+			cfsDropped[f] = 1;
+		}
+	}
+	
+	//  Every node is evaluated for the first pattern
+	for(i = 0;i<N;++i){
+		cfsSchedule(i);
+	}
+	
+	for(int patt = 0;patt<inputPatterns.size();++patt){
+		//  Apply the pattern; only changed PI's cause events
+		for(i = 0;i<PI_list.size();++i){
+			int n = ref2index[PI_list[i]];
+			unsigned char logic;
+			switch(inputPatterns[patt][i]){
+				case '0':
+					logic = CFS_ZERO;
+					break;
+				case '1':
+					logic = CFS_ONE;
+					break;
+				default:
+					logic = CFS_X;
+			}
+			if(logic != cfsGood[n]){
+				cfsGood[n] = logic;
+				cfsSchedule(n);
+				for(int k = 0;k<NodeV[n].fout;++k){
+					cfsSchedule(ref2index[NodeV[n].downNodes[k]]);
+				}
+			}
+		}
+		
+		cfsPropagate();
+		
+		//  A faulty machine still present at a PO is detected
+		for(int nPo = 0;nPo<PO_Nodes.size();++nPo){
+			vector<CFREC> &list = cfsList[ref2index[PO_Nodes[nPo]]];
+			for(int r = 0;r<list.size();++r){
+				f = list[r].fault;
+				if(cfsDropped[f] || cfsFoundIn[f]==patt){
+					continue;
+				}
+				cfsFoundIn[f] = patt;
+				FaultV[f].faultFound.push_back(patt);
+				if(FaultV[f].faultFound.size()>=N_DROP){
+					cfsDropped[f] = 1;
+				}
+			}
+		}
 	}
+}
+
+void cfsSchedule(int n){
+	//  Add node index n to the level queue
+	if(!cfsQueued[n]){
+		cfsQueued[n] = 1;
+		cfsQueue[NodeV[n].level].push_back(n);
+	}
+}
+
+void cfsPropagate(void){
+	//  Process the level queue, lowest level first
+	vector<CFREC> newList;
+	for(int lev = 0;lev<cfsQueue.size();++lev){
+		for(int q = 0;q<cfsQueue[lev].size();++q){
+			int n = cfsQueue[lev][q];
+			cfsQueued[n] = 0;
+			
+			unsigned char good;
+			cfsEvalNode(n, good, newList);
+			
+			bool changed = (good != cfsGood[n]) || (newList.size() != cfsList[n].size());
+			for(int r = 0;!changed && r<newList.size();++r){
+				changed = (newList[r].fault != cfsList[n][r].fault) ||
+					(newList[r].logic != cfsList[n][r].logic);
+			}
+			if(!changed){
+				continue;
+			}
+			cfsGood[n] = good;
+			cfsList[n].swap(newList);
+			for(int k = 0;k<NodeV[n].fout;++k){
+				cfsSchedule(ref2index[NodeV[n].downNodes[k]]);
+			}
+		}
+		cfsQueue[lev].clear();
+	}
+}
+
+void cfsEvalNode(int n, unsigned char &good, vector<CFREC> &list){
+	//  Good logic and faulty machine list of node index n.
+	//  The input lists are merged by fault; an input without a record
+	//  for a fault has its good logic in that machine.
+	NSTRUC *np = &NodeV[n];
+	int N_inputs = np->upNodes.size();
+	vector<int> &local = cfsLocal[n];
+	static vector<unsigned char> vals;
+	static vector<int> pos, in;
+	int lpos = 0;
+	int j;
 	
+	list.clear();
+	if(vals.size()<N_inputs+1){
+		vals.resize(N_inputs+1);
+		pos.resize(N_inputs+1);
+		in.resize(N_inputs+1);
+	}
+	for(j = 0;j<N_inputs;++j){
+		in[j] = ref2index[np->upNodes[j]];
+		vals[j] = cfsGood[in[j]];
+		pos[j] = 0;
+	}
+	good = (N_inputs==0) ? cfsGood[n] : cfsGate(np, vals.data());
 	
+	while(1){
+		//  Next fault with a record at an input or located here
+		int f = INT_MAX;
+		for(j = 0;j<N_inputs;++j){
+			vector<CFREC> &inList = cfsList[in[j]];
+			while(pos[j]<inList.size() && cfsDropped[inList[pos[j]].fault]){
+				++pos[j];
+			}
+			if(pos[j]<inList.size()){
+				f = min(f, inList[pos[j]].fault);
+			}
+		}
+		while(lpos<local.size() && cfsDropped[local[lpos]]){
+			++lpos;
+		}
+		if(lpos<local.size()){
+			f = min(f, local[lpos]);
+		}
+		if(f==INT_MAX){
+			break;
+		}
+		
+		unsigned char logic = good;
+		if(N_inputs>0){
+			for(j = 0;j<N_inputs;++j){
+				vector<CFREC> &inList = cfsList[in[j]];
+				if(pos[j]<inList.size() && inList[pos[j]].fault==f){
+					vals[j] = inList[pos[j]].logic;
+					++pos[j];
+				}else{
+					vals[j] = cfsGood[in[j]];
+				}
+			}
+			logic = cfsGate(np, vals.data());
+		}
+		if(lpos<local.size() && local[lpos]==f){
+			logic = FaultV[f].stuckAt ? CFS_ONE : CFS_ZERO;
+			++lpos;
+		}
+		if(logic != good){
+			CFREC rec;
+			rec.fault = f;
+			rec.logic = logic;
+			list.push_back(rec);
+		}
+	}
 }
+
+unsigned char cfsGate(NSTRUC *np, unsigned char *vals){
+	//  Gate function on 2-rail logic, bitwise like simNode3
+	int N_inputs = np->upNodes.size();
+	unsigned char logic = vals[0];
+	unsigned char x;
+	switch(np->gateType){
+		case XOR:
+		case XNOR:
+			for(int j = 1;j<N_inputs;++j){
+				//  Bitwise XOR with simNode3's fix for 'X'
+				x = logic ^ vals[j];
+				logic = ((x & (x>>1)) & 1) | (((x | (x>>1)) & 1)<<1);
+			}
+			break;
+		case AND:
+		case NAND:
+			for(int j = 1;j<N_inputs;++j){
+				logic &= vals[j];
+			}
+			break;
+		case OR:
+		case NOR:
+			for(int j = 1;j<N_inputs;++j){
+				logic |= vals[j];
+			}
+			break;
+		case IPT:
+		case BRCH:
+		case NOT:
+			break;
+		default:
+			printf("Node type %d not recognized\n",np->gateType);
+			return CFS_X;
+	}
+	if((np->gateType == XNOR)||
+		(np->gateType==NAND) ||
+		(np->gateType==NOR) ||
+		(np->gateType==NOT))
+	{
+		//  C1 = NOT(A2), C2 = NOT(A1)
+		logic = ((~logic>>1) & 1) | ((~logic & 1)<<1);
+	}
+	return logic;
+}
+
 void RTG(char *cp)
 {
 	//  Performs random test pattern simulation
@@ -1616,36 +2258,35 @@ void genAllFaults(void){
 	}	
 }
 
-void setFaults(int indStart, int indEnd){
+template<typename W> void setFaults(vector<PSTRUC<W> >& ps, int indStart, int indEnd){
 	//  Cycles through the "FaultV" vector
 	//  Each fault is set at that node with 
 	//  the fault "fmask_OR" and "fmask_AND".
 	int f;
 	int ref;
-	NSTRUC *np;
+	PSTRUC<W> *pp;
 	FSTRUC *fp;
 	
-	resetFaultMasks();
+	resetFaultMasks(ps);
 	
 	
 	int bitCounter = 1;//  Start at second bit
 	for(f = indStart;f<=indEnd;++f){
 		fp = &FaultV[f];
-		np = getNodePtr(fp->ref);
-		//np = &NodeV[ref2index[fp->ref]];
+		pp = &ps[ref2index[fp->ref]];
 		if(fp->stuckAt){
 			//  Stuck at 1
-			np->fmask_OR = (np->fmask_OR)|(1U<<bitCounter);
+			wordSetBit(pp->fmask_OR, bitCounter);
 		}else{
 			//  Stuck at 0
-			np->fmask_AND = (np->fmask_AND)&(~(1U<<bitCounter));
+			wordClearBit(pp->fmask_AND, bitCounter);
 		}
 		bitCounter++;
 	}
 }
 
 //  
-void checkFaults(int indStart,int indEnd, int patt){
+template<typename W> void checkFaults(vector<PSTRUC<W> >& ps, int indStart,int indEnd, int patt){
 	//  This function checks to see if faults have been
 	//  detected.  Cycles through each fault as indicated
 	//  by the "indStart" and "indEnd" (referenced to "FaultV").
@@ -1653,10 +2294,9 @@ void checkFaults(int indStart,int indEnd, int patt){
 	//  output has changed with that fault.  If it has, the 
 	//  current pattern reference that found that fault is added.
 	int f;
-	unsigned int temp;
 	int nPo;
 	bool detected;
-	NSTRUC *np;
+	PSTRUC<W> *pp;
 	FSTRUC *fp;
 	int bitCounter = 1;//  Start at second bit
 	for(f = indStart; f<=indEnd;++f){
@@ -1664,14 +2304,11 @@ void checkFaults(int indStart,int indEnd, int patt){
 		detected = false;
 		for(nPo = 0;nPo<PO_Nodes.size();++nPo){
 			//  Get pointer to a PO
-			np = getNodePtr(PO_Nodes[nPo]);
-			//np = &NodeV[ref2index[PO_Nodes[nPo]]];
+			pp = &ps[ref2index[PO_Nodes[nPo]]];
 			//  Check if logic at bitCounter 
 			//  is different than bit 0
 			for(int k=0;k<2;k++){
-				temp = np->logic3[k]& (1U<<bitCounter);
-				temp = temp>>bitCounter;
-				detected = detected|((np->logic3[k]&1U)!= temp);
+				detected = detected|(wordGetBit(pp->logic3[k], 0) != wordGetBit(pp->logic3[k], bitCounter));
 			}
 			
 			if(detected){
@@ -1687,7 +2324,6 @@ void checkFaults(int indStart,int indEnd, int patt){
 		++bitCounter;
 	}//  Loop for each fault
 }
-
 void genRandomInputs(int N_patterns){
 	//  Generate vector of random inputs.
 	//  Random seed already initialized in "main".
@@ -1777,14 +2413,11 @@ void lSim(char *cp)
 	printInputPatterns();
 	// --------------------------
 	
-	// Set all fault masks to known value
-	//  No faults are being simulated here
-	resetFaultMasks();
-	
 	//  Clear output
 	outputPatterns.clear();
 	
 	//  Perform Simulation
+	//  No faults are being simulated here
 	parallelLogicSimulation();
 	
 	//  Write Results
@@ -1795,25 +2428,14 @@ void lSim(char *cp)
 }
 
 void multi_dfs(char *cp){
-	dfs_fault_list.clear();
-	fault_vals.clear();
-	inputPatterns.clear();
-	//int_inputPatterns.clear();
-	vector<int>::iterator it;
-	vector<int> u, v;
-	std::map<int, vector<int> >::iterator itr;
-	vector<string>::iterator s;
-	vector<NSTRUC>::iterator np, ns = NodeV.begin();
+	//  Deductive fault simulation
+	//  Read in format:
+	//     DFS <pattern-file> <output-file>
+	//  Writes every fault detected by at least one pattern, in the
+	//  order the faults are first detected.
 	char readFile[MAXLINE];
 	char writeFile[MAXLINE];
-	int i, j = 1, max = 0;
-	vector<char>::iterator ch;
-	fstream file;;
-	NSTRUC *inNode;
-	bool run_again = false;
-	dfs_count = 1;
-	final.clear();
-	
+	fstream file;
 	
 	sscanf(cp, "%s %s", readFile, writeFile);
 	//   Debug //////////////
@@ -1822,278 +2444,370 @@ void multi_dfs(char *cp){
 	printf("Output Results: %s\n",writeFile);
 	///////////////////
 	
-	rtp(readFile);
-	
-	for(np = NodeV.begin(); np!= NodeV.end(); np++){
-			if(np->ref > max){
-				max = np->ref;
-		}
+	if(!rtp(readFile)){
+		return;
 	}
 	
-	for(i = 0; i < inputPatterns.size(); i++)
-	{
-		dfs_logicSim( i);
-		if(dfs_count == 1){
-			for(np = NodeV.begin(); np != NodeV.end(); np++){
-				prevLogic.push_back(np->logic);
-				single_dfs(np->ref);
-				
-			}
-		}
-		else{
-			int x = 0;
-			for(np = NodeV.begin(); np != NodeV.end(); np++){
-				if(np->logic != prevLogic[x]){
-					dfs_fault_list.erase(np->ref);
-					for(int k = 0; k < np->fin; k++){
-						dfs_fault_list.erase(np->upNodes[k]);
-						single_dfs(np->upNodes[k]);
-					}
-					
-					single_dfs(np->ref);
-				}
-				x++;
-			}
-			
-		}
-		dfs_count++;
-		for(int k = 0;k<PO_Nodes.size();++k)
-		//for(np = PO_Nodes.begin(); np!= PO_Nodes.end(); np++)
-		{
-			NSTRUC *ndPtr = getNodePtr(PO_Nodes[k]);
-			//np = &NodeV[ref2index[PO_Nodes[k]]];
-			for(it = dfs_fault_list[ndPtr->ref].begin(); it != dfs_fault_list[ndPtr->ref].end(); it++){
-				if(*it > 0 && *it <= max){
-					if(std::find(final.begin(), final.end(), *it) == final.end())
-					{
-						final.push_back(*it);			
-					}
+	dfsInit();
+	
+	//  Faults detected so far, in detection order
+	vector<int> detectedOrder;
+	
+	for(int patt = 0; patt < inputPatterns.size(); patt++){
+		dfsPattern(patt);
+		for(int k = 0; k < PO_Nodes.size(); k++){
+			int n = ref2index[PO_Nodes[k]];
+			uint64_t *row = &dfs_fault_list[(size_t)n*dfsWords];
+			for(int w = dfsLo[n]; w < dfsHi[n]; w++){
+				uint64_t newFaults = row[w] & ~dfsDetected[w];
+				dfsDetected[w] |= newFaults;
+				while(newFaults){
+					detectedOrder.push_back(64*w + __builtin_ctzll(newFaults));
+					newFaults &= newFaults - 1;
 				}
-				
 			}
 		}
 	}
+	
 	file.open(writeFile, ios_base::out);
     if(!file.is_open())
     {
         cout<<"Unable to open the file.\n";
         return;
 	}
-	for(it = final.begin(); it != final.end(); it++)
+	for(int j = 0; j < detectedOrder.size(); j++)
 	{
-		file<<*it<<"@"<<fault_vals[*it]<<"\n";
+		//  Fault ID is 2*index + stuck-at value
+		file<<NodeV[detectedOrder[j]>>1].ref<<"@"<<(detectedOrder[j]&1)<<"\n";
 	}
+	file.close();
 	
 	//  Print "OK"
 	printf("\n==> OK\n");
 }
 
-void helper_dfs(int c, int i, int val){
-	NSTRUC *inNode;
-	vector<NSTRUC>::iterator nstr;
-	int flag = 0, j, ind;
-	vector<int> output1, output2, output3, output, c_list, n_list;
-	vector<int>::iterator it, out;
-	map<int, vector<int> >::iterator itr;
-	output.clear();
-	output1.clear();
-	output2.clear();
-	c_list.clear();
-	n_list.clear();
-	//NSTRUC *np = &NodeV[ref2index[val]];
-	NSTRUC *np = getNodePtr(val);
-	for(j = 0; j < np->fin; j++){
-		inNode = getNodePtr(np->upNodes[j]);
-		//inNode = &NodeV[ref2index[np->upNodes[j]]];
-		if(inNode->logic == c){
-			c_list.push_back(inNode->ref);
-			if(c_list.size() == 1){
-				for(it = dfs_fault_list[inNode->ref].begin(); it != dfs_fault_list[inNode->ref].end(); it++){
-					output1.push_back(*it);
+void dfsInit(void){
+	//  Size the fault list rows and order the nodes by level.
+	//  Rows: [0, N) flip lists, [N, 2N) unknown lists, then 2 scratch rows
+	dfsWords = intCeil(2*NodeV.size(), 64);
+	int rows = 2*NodeV.size() + 2;
+	dfs_fault_list.assign((size_t)rows*dfsWords, 0);
+	dfsLo.assign(rows, 0);
+	dfsHi.assign(rows, 0);
+	dfsLogic.assign(NodeV.size(), 2);
+	dfsDetected.assign(dfsWords, 0);
+	
+	dfsOrder.resize(NodeV.size());
+	for(int i = 0; i < NodeV.size(); i++){
+		dfsOrder[i] = make_pair(NodeV[i].level, i);
+	}
+	sort(dfsOrder.begin(), dfsOrder.end());
+}
+
+void dfsPattern(int patt){
+	//  Good simulation and fault list computation for one pattern,
+	//  one pass over the nodes in level order.
+	//  Good logic is 0, 1 or 2 (X). For a node with binary good logic,
+	//  row n holds the faults that flip it and row N+n the faults that
+	//  may turn it into X. Nodes at X keep both rows empty; every fault
+	//  is taken to leave them at X, which is never optimistic.
+	//  Without X in the pattern all unknown rows stay empty.
+	int i, j;
+	int N = NodeV.size();
+	int t1 = 2*N;		//  scratch rows
+	int t2 = 2*N + 1;
+	
+	for(i = 0; i < PI_Nodes.size(); i++){
+		dfsLogic[ref2index[PI_Nodes[i]]] = 2;
+	}
+	for(i = 0; i < PI_list.size(); i++){
+		char logic = inputPatterns[patt][i];
+		dfsLogic[ref2index[PI_list[i]]] = (logic == '0') ? 0 : ((logic == '1') ? 1 : 2);
+	}
+	
+	for(int o = 0; o < dfsOrder.size(); o++){
+		int n = dfsOrder[o].second;
+		NSTRUC *np = &NodeV[n];
+		int N_inputs = np->upNodes.size();
+		dfsClear(n);
+		dfsClear(N + n);
+		
+		if(N_inputs==0){
+			//  PI; logic already set, list is just the local fault
+		}else if(N_inputs==1){
+			//  Branch, inverter, buffer or single input gate; lists pass through
+			int in = ref2index[np->upNodes[0]];
+			dfsLogic[n] = dfsLogic[in];
+			if((dfsLogic[n] != 2)&&((np->gateType == NOT)||(np->gateType == NAND)||
+				(np->gateType == NOR)||(np->gateType == XNOR))){
+				dfsLogic[n] = 1 - dfsLogic[n];
+			}
+			if(dfsLogic[n] != 2){
+				dfsUnion(n, in);
+				dfsUnion(N + n, N + in);
+			}
+		}else if((np->gateType == XOR)||(np->gateType == XNOR)){
+			//  A fault flips the output if it flips an odd number of
+			//  inputs and leaves no input unknown
+			int parity = (np->gateType == XNOR) ? 1 : 0;
+			for(j = 0; j < N_inputs; j++){
+				int in = ref2index[np->upNodes[j]];
+				if(dfsLogic[in] == 2){
+					parity = 2;
+					break;
+				}
+				parity ^= dfsLogic[in];
+			}
+			dfsLogic[n] = parity;
+			if(parity != 2){
+				for(j = 0; j < N_inputs; j++){
+					int in = ref2index[np->upNodes[j]];
+					dfsXor(n, in);
+					dfsUnion(N + n, N + in);
 				}
+				dfsDifference(n, N + n);
 			}
-		} 
-		else{
-			n_list.push_back(inNode->ref);
-			if(n_list.size() == 1){
-				for(it = dfs_fault_list[inNode->ref].begin(); it != dfs_fault_list[inNode->ref].end(); it++){
-					output2.push_back(*it);
+		}else{
+			//  AND, NAND, OR, NOR
+			//  c: controlling value, inv: output inversion
+			int c = ((np->gateType == OR)||(np->gateType == NOR)) ? 1 : 0;
+			int inv = ((np->gateType == NAND)||(np->gateType == NOR)) ? 1 : 0;
+			int nControl = 0;
+			bool hasX = false;
+			bool hasUnknown = false;
+			for(j = 0; j < N_inputs; j++){
+				int in = ref2index[np->upNodes[j]];
+				if(dfsLogic[in] == c){
+					nControl++;
+				}else if(dfsLogic[in] == 2){
+					hasX = true;
+				}
+				if(dfsLo[N + in] < dfsHi[N + in]){
+					hasUnknown = true;
 				}
 			}
+			
+			if(nControl > 0){
+				dfsLogic[n] = c ^ inv;
+				//  Flips: faults that flip every controlling input and
+				//  leave every other input at its value. Not possible
+				//  with an X input.
+				if(!hasX){
+					bool first = true;
+					for(j = 0; j < N_inputs; j++){
+						int in = ref2index[np->upNodes[j]];
+						if(dfsLogic[in] != c){continue;}
+						if(first){
+							dfsUnion(n, in);
+							first = false;
+						}else{
+							dfsIntersect(n, in);
+						}
+					}
+					for(j = 0; j < N_inputs && dfsLo[n] < dfsHi[n]; j++){
+						int in = ref2index[np->upNodes[j]];
+						if(dfsLogic[in] != c){
+							dfsDifference(n, in);
+							dfsDifference(n, N + in);
+						}
+					}
+				}
+				//  Unknown: every controlling input flips or goes X and
+				//  no other input flips to the controlling value
+				if(hasX || hasUnknown){
+					bool first = true;
+					for(j = 0; j < N_inputs; j++){
+						int in = ref2index[np->upNodes[j]];
+						if(dfsLogic[in] != c){continue;}
+						int row = first ? t1 : t2;
+						dfsClear(row);
+						dfsUnion(row, in);
+						dfsUnion(row, N + in);
+						if(!first){
+							dfsIntersect(t1, t2);
+						}
+						first = false;
+					}
+					for(j = 0; j < N_inputs && dfsLo[t1] < dfsHi[t1]; j++){
+						int in = ref2index[np->upNodes[j]];
+						if(dfsLogic[in] != c){
+							dfsDifference(t1, in);
+						}
+					}
+					dfsDifference(t1, n);
+					dfsUnion(N + n, t1);
+					dfsClear(t1);
+					dfsClear(t2);
+				}
+			}else if(hasX){
+				dfsLogic[n] = 2;
+			}else{
+				//  All inputs non-controlling; an input flip propagates
+				dfsLogic[n] = (1 - c) ^ inv;
+				for(j = 0; j < N_inputs; j++){
+					int in = ref2index[np->upNodes[j]];
+					dfsUnion(n, in);
+					dfsUnion(N + n, N + in);
+				}
+				dfsDifference(N + n, n);
+			}
+		}
+		
+		//  Local fault: stuck at the opposite of the good value.
+		//  Detected faults are dropped; they are never injected again.
+		if(dfsLogic[n] != 2){
+			int faultID = 2*n + (1 - dfsLogic[n]);
+			if(!((dfsDetected[faultID>>6] >> (faultID&63)) & 1)){
+				dfsAddFault(n, faultID);
+			}
+			np->logic = dfsLogic[n];
 		}
 	}
-	
-	for(j = 0; j < c_list.size(); j++){
-		std::set_intersection(output1.begin(),output1.end(), dfs_fault_list[c_list[j]].begin(),dfs_fault_list[c_list[j]].end(), std::inserter(output3 ,output3.begin()));
-		output1.clear();
-		copy(output3.begin(), output3.end(), std::inserter(output1, output1.begin()));
-		output3.clear();
+}
+
+//  Fault list rows are dense bitsets of dfsWords words. Only words in
+//  [dfsLo, dfsHi) may be non-zero, so the set operations below only
+//  touch the populated part of each row.
+void dfsClear(int n){
+	uint64_t *row = &dfs_fault_list[(size_t)n*dfsWords];
+	for(int w = dfsLo[n]; w < dfsHi[n]; w++){
+		row[w] = 0;
 	}
-	for(j = 0; j < n_list.size(); j++){
-		std::set_union(output2.begin(),output2.end(), dfs_fault_list[n_list[j]].begin(),dfs_fault_list[n_list[j]].end(), std::inserter(output2 ,output2.begin()));
+	dfsLo[n] = 0;
+	dfsHi[n] = 0;
+}
+
+void dfsTrim(int n){
+	uint64_t *row = &dfs_fault_list[(size_t)n*dfsWords];
+	while((dfsLo[n] < dfsHi[n])&&(row[dfsLo[n]] == 0)){
+		dfsLo[n]++;
 	}
-	if(c_list.size() > 0){
-		std::set_difference(output1.begin(),output1.end(), output2.begin(), output2.end(), std::inserter(output, output.begin()));
-		fault_vals.insert(pair<int, int>(np->ref, (c ^ (1-i))));
+	while((dfsHi[n] > dfsLo[n])&&(row[dfsHi[n]-1] == 0)){
+		dfsHi[n]--;
 	}
-	else{
-		copy(output2.begin(), output2.end(), std::inserter(output, output.begin()));
-		fault_vals.insert(pair<int, int>(np->ref, (c ^ i)));
+	if(dfsLo[n] == dfsHi[n]){
+		dfsLo[n] = 0;
+		dfsHi[n] = 0;
 	}
-	output.push_back(np->ref);
-	dfs_fault_list.insert(pair<int, vector<int> >(np->ref, output));
 }
 
-void single_dfs(int val)
-{
-	int c, i, j, ind;
-	std::map<int, vector<int> >::iterator itr;
-	FILE *fptr;
-	vector<int> output, output1, output2;
-	vector<int>::iterator it;
-	//vector<int>::iterator nstr_it;
-	char readFile[MAXLINE];
+void dfsWiden(int n, int lo, int hi){
+	//  Grow the populated range of row n to cover [lo, hi)
+	if(dfsLo[n] == dfsHi[n]){
+		dfsLo[n] = lo;
+		dfsHi[n] = hi;
+	}else{
+		dfsLo[n] = min(dfsLo[n], lo);
+		dfsHi[n] = max(dfsHi[n], hi);
+	}
+}
 
-	NSTRUC *np, *inNode, *ptr1, *ptr2;
-	np = getNodePtr(val);
-  	//np = &NodeV[ref2index[val]];
-	for(i = 0; i < np->fin; i++){
-		if(dfs_count == 1){
-			if(dfs_fault_list.find(np->upNodes[i]) == dfs_fault_list.end()){
-				reVisit.push_back(np->upNodes[i]);
-				single_dfs(np->upNodes[i]);
-			}
-		}	
+void dfsUnion(int dst, int src){
+	if(dfsLo[src] == dfsHi[src]){return;}
+	uint64_t *d = &dfs_fault_list[(size_t)dst*dfsWords];
+	const uint64_t *s = &dfs_fault_list[(size_t)src*dfsWords];
+	for(int w = dfsLo[src]; w < dfsHi[src]; w++){
+		d[w] |= s[w];
 	}
+	dfsWiden(dst, dfsLo[src], dfsHi[src]);
+}
 
+void dfsIntersect(int dst, int src){
+	uint64_t *d = &dfs_fault_list[(size_t)dst*dfsWords];
+	const uint64_t *s = &dfs_fault_list[(size_t)src*dfsWords];
+	for(int w = dfsLo[dst]; w < dfsHi[dst]; w++){
+		d[w] = ((w >= dfsLo[src])&&(w < dfsHi[src])) ? (d[w] & s[w]) : 0;
+	}
+	dfsTrim(dst);
+}
 
-	switch (np->gateType){
-		case IPT:
-			output.clear();
-			output.push_back(np->ref);
-			dfs_fault_list.insert(pair<int,vector<int> >(np->ref, output));
-			fault_vals.insert(pair<int, int>(np->ref, (1-np->logic)));
-			break;
-		case BRCH:
-			output.clear();
-			for(j = 0; j < np->fin; j++){
-				inNode = getNodePtr(np->upNodes[j]);
-				//inNode = &NodeV[ref2index[np->upNodes[j]]];
-				for(ind = 0; ind < dfs_fault_list[inNode->ref].size(); ind++)
-					output.push_back(dfs_fault_list[inNode->ref][ind]);
-			}
-			output.push_back(np->ref);
-			dfs_fault_list.insert(pair<int,vector<int> >(np->ref, output));
-			fault_vals.insert(pair<int, int>(np->ref, (1-np->logic)));
-			break;
-		case OR:
-			c = 1;
-			i = 0;
-			helper_dfs(c, i, val);
-			break;
-		case NOR:
-			c = 1;
-			i = 1;
-			helper_dfs(c, i, val);
-			break;
-		case AND:
-			c = 0;
-			i = 0;
-			helper_dfs(c, i, val);
-			break;
-		case NAND:
-			c = 0;
-			i = 1;
-			helper_dfs(c, i, val);
-			break;
-		case NOT:
-			output.clear();
-			for(j = 0; j < np->fin; j++){
-				inNode = getNodePtr(np->upNodes[j]);
-				//inNode = &NodeV[ref2index[np->upNodes[j]]];
-				for(ind = 0; ind < dfs_fault_list[inNode->ref].size(); ind++)
-					output.push_back(dfs_fault_list[inNode->ref][ind]);
-			}
-			output.push_back(np->ref);
-			dfs_fault_list.insert(pair<int,vector<int> >(np->ref, output));
-			fault_vals.insert(pair<int, int>(np->ref, (1-np->logic)));
+void dfsDifference(int dst, int src){
+	uint64_t *d = &dfs_fault_list[(size_t)dst*dfsWords];
+	const uint64_t *s = &dfs_fault_list[(size_t)src*dfsWords];
+	int lo = max(dfsLo[dst], dfsLo[src]);
+	int hi = min(dfsHi[dst], dfsHi[src]);
+	for(int w = lo; w < hi; w++){
+		d[w] &= ~s[w];
+	}
+	dfsTrim(dst);
+}
+
+void dfsXor(int dst, int src){
+	if(dfsLo[src] == dfsHi[src]){return;}
+	uint64_t *d = &dfs_fault_list[(size_t)dst*dfsWords];
+	const uint64_t *s = &dfs_fault_list[(size_t)src*dfsWords];
+	for(int w = dfsLo[src]; w < dfsHi[src]; w++){
+		d[w] ^= s[w];
+	}
+	dfsWiden(dst, dfsLo[src], dfsHi[src]);
+	dfsTrim(dst);
+}
+
+void dfsAddFault(int n, int faultID){
+	int w = faultID >> 6;
+	dfs_fault_list[(size_t)n*dfsWords + w] |= 1ULL << (faultID & 63);
+	dfsWiden(n, w, w + 1);
+}
+
+void parallelLogicSimulation(void){
+	//  Dispatch to the widest word type the CPU supports
+	switch(parallelWordBits()){
+		case 256:
+			parallelLogicSimulation<word256_t>();
 			break;
-		case XOR:
-			output.clear();
-			ptr1 = getNodePtr(np->upNodes[0]);
-			ptr2 = getNodePtr(np->upNodes[1]);
-			
-			//ptr1 = &NodeV[ref2index[np->upNodes[0]]];
-			//ptr2 = &NodeV[ref2index[np->upNodes[1]]];
-			
-			//std::set_union(dfs_fault_list[ptr1->ref].begin(),dfs_fault_list[ptr1->ref].end(), dfs_fault_list[ptr2->ref].begin(),dfs_fault_list[ptr2->ref].end(), std::inserter(output1, output1.begin()));
-			//std::set_intersection(dfs_fault_list[ptr1->ref].begin(),dfs_fault_list[ptr1->ref].end(), dfs_fault_list[ptr2->ref].begin(),dfs_fault_list[ptr2->ref].end(), std::inserter(output2, output2.begin()));
-			//std::set_difference(output1.begin(),output1.end(), output2.begin(), output2.end(), std::inserter(output, output.begin()));
-			output1.clear();
-			output2.clear();
-			//ptr1 = &NodeV[ref2index[np->upNodes[0]]];
-			//ptr2 = &NodeV[ref2index[np->upNodes[1]]];
-			if(ptr1->logic == ptr2->logic){
-				std::set_union(dfs_fault_list[ptr1->ref].begin(),dfs_fault_list[ptr1->ref].end(), dfs_fault_list[ptr2->ref].begin(),dfs_fault_list[ptr2->ref].end(), std::inserter(output1, output1.begin()));
-				std::set_intersection(dfs_fault_list[ptr1->ref].begin(),dfs_fault_list[ptr1->ref].end(), dfs_fault_list[ptr2->ref].begin(),dfs_fault_list[ptr2->ref].end(), std::inserter(output2, output2.begin()));
-				std::set_difference(output1.begin(),output1.end(), output2.begin(), output2.end(), std::inserter(output, output.begin()));
-			}
-			else{
-				std::set_union(dfs_fault_list[ptr1->ref].begin(),dfs_fault_list[ptr1->ref].end(), dfs_fault_list[ptr2->ref].begin(),dfs_fault_list[ptr2->ref].end(), std::inserter(output, output.begin()));
-			}
-			output.push_back(np->ref);
-			dfs_fault_list.insert(pair<int,vector<int> >(np->ref, output));
-			fault_vals.insert(pair<int, int>(np->ref, (1-np->logic)));
+		case 128:
+			parallelLogicSimulation<word128_t>();
 			break;
 		default:
-			printf("Node type %d not recognized\n",np->gateType);
+			parallelLogicSimulation<uint64_t>();
 	}
 }
 
-void parallelLogicSimulation(void){
+template<typename W> void parallelLogicSimulation(void){
 	//  Parallel Logic Simulation
 		
 	//  Determine the # of passes to simulate input
-	//  Can only do 32/64 patterns per pass (Depending on word width)
+	//  Can only do one pattern per bit of the word type
 	int N_passes, N_patterns, n_patterns;
+	int width = wordBits<W>();
+	vector<PSTRUC<W> > ps;
+	initParallelState(ps);
 	N_patterns = inputPatterns.size();
-	//  Get ceil of N_patterns/bitWidth;
-	N_passes = intCeil(N_patterns, bitWidth);
+	//  Get ceil of N_patterns/width;
+	N_passes = intCeil(N_patterns, width);
 	int indStart, indEnd;
 	int Pass, patt;
 	//  Start going through the passes
 	for(Pass=0;Pass<N_passes;Pass++){
 		//  Find start and stop indexes in test pattern list for this pass
-		indStart = Pass*bitWidth;
-		indEnd = indStart+min(bitWidth, N_patterns-Pass*bitWidth) -1;
+		indStart = Pass*width;
+		indEnd = indStart+min(width, N_patterns-Pass*width) -1;
 		//  Write test patterns to PI's
-		setPI_forPLS(indStart, indEnd);
+		setPI_forPLS(ps, indStart, indEnd);
 
 		//  Add PI list to queue
-		addPiNodesToQueue();
+		addPiNodesToQueue(nodeQueue);
 		
 		// Process the Node queue
 		// Simulates logic of each node
-		processNodeQueue();
+		processNodeQueue(ps, nodeQueue);
 		
 		//  Add results to output array
 		n_patterns = indEnd-indStart+1;
-		addOutputPattern(n_patterns);
+		addOutputPattern(ps, n_patterns);
 	}
 }
 
 
-char getLogic(int nodeRef,int index){
+template<typename W> char getLogic(vector<PSTRUC<W> >& ps, int nodeRef,int index){
 	//  Returns an ascii character based on the logic at the specified index
-	//  Logic is 3x32 or 3x64, each column is a result from a test pattern
-	NSTRUC *np;
+	//  Logic is 3 words, each bit is a result from a test pattern
+	PSTRUC<W> *pp;
 	bool log[3];
-	np = getNodePtr(nodeRef);
-	//np = &NodeV[ref2index[nodeRef]];
-	unsigned int mask = 1U<<index;
+	pp = &ps[ref2index[nodeRef]];
 	for(int i = 0;i<3;i++){
 		//  Isolate only the bit at index
-		log[i] = (np->logic3[i] & mask);
+		log[i] = wordGetBit(pp->logic3[i], index);
 	}
 	if((log[0]==false) & (log[1]==false)){
 		return '0';
@@ -2110,85 +2824,79 @@ char getLogic(int nodeRef,int index){
 	
 }
 
-void setPI_forPFS(int patt){
+template<typename W> void setPI_forPFS(vector<PSTRUC<W> >& ps, int patt){
 	//  This function assigns the specified test patterns 
 	//  to the PI's for paralell fault simulation
 	//  Only 1 input pattern is used
-	NSTRUC *np;
+	PSTRUC<W> *pp;
 	int PI, k;
 	//  Cycle through each PI and apply the test pattern
 
 	for(int PI = 0;PI<PI_list.size();PI++){
 		//  Get the current PI
-		np = getNodePtr(PI_list[PI]);
-		//np = &NodeV[ref2index[PI_list[PI]]];
+		pp = &ps[ref2index[PI_list[PI]]];
 
 		//Get logic value of this PI for this test pattern
 		char logic = inputPatterns[patt][PI];
 		switch (logic){
 			case '0':
 				//0;0;0
-				np->logic3[0] = 0u;
-				np->logic3[1] = 0u;
-				np->logic3[2] = 0u;
-				np->logic = false;
+				wordZeros(pp->logic3[0]);
+				wordZeros(pp->logic3[1]);
+				wordZeros(pp->logic3[2]);
 				break;
 			case '1':
 				// 1;1;0
-				np->logic3[0] = ~0u;
-				np->logic3[1] = ~0u;
-				np->logic3[2] = 0u;
-				np->logic = true;
+				wordOnes(pp->logic3[0]);
+				wordOnes(pp->logic3[1]);
+				wordZeros(pp->logic3[2]);
 				break;
 			default:
 				// 0;1;0
-				np->logic3[0] = 0u;
-				np->logic3[1] = ~0u;
-				np->logic3[2] = 0u;
-				np->logic = false;
+				wordZeros(pp->logic3[0]);
+				wordOnes(pp->logic3[1]);
+				wordZeros(pp->logic3[2]);
 		}
 	}// End loop for each PI
 	
 }
 
-void setPI_forPLS(int indStart, int indEnd){
+template<typename W> void setPI_forPLS(vector<PSTRUC<W> >& ps, int indStart, int indEnd){
 	//  This function assigns the specified test patterns 
 	//  to the PI's for paralell logic simulation
-	//  0 to 32/64 input patterns are used
+	//  Pattern indStart+k is written to bit k
 	NSTRUC *np;
+	PSTRUC<W> *pp;
 	int PI, k, patt;
 	//  Cycle through each PI and apply all of the test patterns
-	//  simultaneously (max of 32 or 64 )
+	//  simultaneously (max of one per bit)
 	for(int PI = 0;PI<PI_list.size();PI++){
 		//  Get the current PI
 		np = getNodePtr(PI_list[PI]);
+		pp = &ps[ref2index[PI_list[PI]]];
 		//  Set to initial state of 'X'
-		np->logic3[0] = 0;
-		np->logic3[1] = ~0;// set to all 1's
-		np->logic3[2] = 0;
+		wordZeros(pp->logic3[0]);
+		wordOnes(pp->logic3[1]);// set to all 1's
+		wordZeros(pp->logic3[2]);
 		for(int patt =indStart;patt<=indEnd;patt++){
 			//Cycle through each test pattern
 			//Get logic value of this PI for this test pattern
 			char logic = inputPatterns[patt][PI];
-			//Left<<shift adds 0 to the LSB
-			np->logic3[0] = np->logic3[0]<<1U;
-			np->logic3[1] = np->logic3[1]<<1U;
-			np->logic3[2] = np->logic3[2]<<1U;
+			int bit = patt-indStart;
 			np->logic = false;
 			switch (logic){
 				case '0':
-					//  Nothing to do here; already set to 
 					// 0;0;0
+					wordClearBit(pp->logic3[1], bit);
 					break;
 				case '1':
 					// 1;1;0
-					np->logic3[0] += 1u;
-					np->logic3[1] += 1u;
+					wordSetBit(pp->logic3[0], bit);
 					np->logic = true;
 					break;
 				default:
 					// 0;1;0
-					np->logic3[1] += 1u;
+					break;
 			}
 		}//  End loop for each test pattern
 	}// End loop for each PI
@@ -2221,89 +2929,66 @@ void addNodeToQueue(vector< pair<int,int> >& queue, int nodeRef){
 	sort(queue.rbegin(), queue.rend());
 }
 
-void addPiNodesToQueue(void){
-	nodeQueue.clear();
+void addPiNodesToQueue(vector< pair<int,int> >& queue){
+	queue.clear();
 	for(int j=0;j<PI_list.size();j++){
-		addNodeToQueue(nodeQueue, PI_list[j]);
+		addNodeToQueue(queue, PI_list[j]);
 	}
 }
 
-//void dfs_logicSim(char *cp, int i)
-void dfs_logicSim(int patt)
-{
-	//std::vector<NSTRUC>::iterator printnode, outitr;
-	//vector<vector<char> >::iterator ch;
-	//FILE *fptr;
-	int j;
-	//char writeFile[MAXLINE];
-	NSTRUC *np;
-	
-	//  Set input pattern at PI's
-	setPI_forPFS(patt);
-	
-	// Set all fault masks to known value
-	resetFaultMasks();
-			
-	//  Add PI list to queue
-	addPiNodesToQueue();
-	
-	//levelizeNodes();//  Only done once when circuit read-in
-	processNodeQueue();
-	//printf("==> OK\n");
-}
-
-void processNodeQueue(void){
+template<typename W> void processNodeQueue(vector<PSTRUC<W> >& ps, vector< pair<int,int> >& queue){
 	//  Function to process all of the nodes in the queue
 	//  Need to determine current logic of these nodes based on the inputs
 	//  Assumes levelization has already occurred.
 	NSTRUC *np;
 	bool logicChanged;
-	while (nodeQueue.size()>0){
+	while (queue.size()>0){
 		//  Get pointer to the last node in the queue
 		//  This will have the lowest level
-		np = getNodePtr(nodeQueue.back().second);
-		nodeQueue.pop_back();//  Remove this node
+		np = getNodePtr(queue.back().second);
+		queue.pop_back();//  Remove this node
 		//  Perform logic simulation
 		//printf("Processing Node %d\n",np->ref);
-		logicChanged = simNode3(np->ref);
+		logicChanged = simNode3(ps, np->ref);
 		//  Now add all downstream nodes to the queue if the logic changed
 		//  If not event-driven, add all nodes regardless
 		if ((logicChanged)||(eventDriven == false)){
 			for(int k = 0;k<np->fout;k++){
-				addNodeToQueue(nodeQueue, np->downNodes[k]);
+				addNodeToQueue(queue, np->downNodes[k]);
 			}	
 		}
 	}
 	
 }
-bool simNode3(int nodeRef){
+template<typename W> bool simNode3(vector<PSTRUC<W> >& ps, int nodeRef){
 	//  Function to determine current logic of this node
 	//  based on logic of upstream nodes.
 	//  Uses 3-bit logic; currently only 0, 1, X
 	//  Output True:   Node logic has changed
 	//  Output False:  Nodelogic has not changed
 	NSTRUC *np;
-	NSTRUC *npIn_A;
-	NSTRUC *npIn_B;
+	PSTRUC<W> *pp;
+	PSTRUC<W> *ppIn_A;
+	PSTRUC<W> *ppIn_B;
 	//  Misc Counters
 	int i, k, inp;
 	
 	// Placeholders for logic
-	unsigned int oldLogic[3], temp0, temp1;
+	W oldLogic[3], temp0, temp1;
 	
 	//  Get pointer to current node
 	np = getNodePtr(nodeRef);
-	//np = &NodeV[ref2index[nodeRef]];
+	pp = &ps[ref2index[nodeRef]];
 	int N_inputs = np->upNodes.size();
 	
 	//  Check if this is a PI
-	if((np->gateType == IPT)||(N_inputs==0)){
+	if(N_inputs==0){
 		//  Input; logic already set
 		//  Nothing to do here except apply fault mask
 		//  Fault Application
 		for(k=0;k<2;k++){
-			np->logic3[k] = np->logic3[k] & np->fmask_AND;
-			np->logic3[k] = np->logic3[k] | np->fmask_OR;		
+			pp->logic3[k] = pp->logic3[k] & pp->fmask_AND;
+			pp->logic3[k] = pp->logic3[k] | pp->fmask_OR;		
 		}
 		//  return true to ensure downstream nodes are processed.
 		return true;
@@ -2311,84 +2996,80 @@ bool simNode3(int nodeRef){
 
 	//  Save current logic to determine if it has changed later
 	for(k=0;k<3;k++){
-		oldLogic[k] = np->logic3[k];
+		oldLogic[k] = pp->logic3[k];
 	}
 	
 	
 	
 	//  Simulate logic ////////////////////
 	//  Get first input node
-	npIn_A = getNodePtr(np->upNodes[0]);
-	//npIn_A = &NodeV[ref2index[np->upNodes[0]]];
+	ppIn_A = &ps[ref2index[np->upNodes[0]]];
 	switch (np-> gateType){
 		case IPT:
-			//  Nothing to do here
-			break;
+			//  Gate typed as input but with a fanin; treat as a buffer
+			//  so no stale value is carried between passes
 		case BRCH:
 			//  Set equal to the input
 			//  Should only be 1 input
 			for(k=0;k<3;k++){
-				np->logic3[k] = npIn_A->logic3[k];
+				pp->logic3[k] = ppIn_A->logic3[k];
 			}
 			break;
 		case XOR:
 		case XNOR:
 			//  Assume only 2 inputs possible
-			npIn_B = getNodePtr(np->upNodes[1]);
-			//npIn_B = &NodeV[ref2index[np->upNodes[1]]];
+			ppIn_B = &ps[ref2index[np->upNodes[1]]];
 			for(k=0;k<3;k++){
 				// Bitwise XOR
-				np->logic3[k] = npIn_A->logic3[k] ^ npIn_B->logic3[k];
+				pp->logic3[k] = ppIn_A->logic3[k] ^ ppIn_B->logic3[k];
 			}
 			//  Fix for inversion with 'X'
-			temp0 = np->logic3[0];
-			temp1 = np->logic3[1];
-			np->logic3[0] = temp0 & temp1;
-			np->logic3[1] = temp0 | temp1;
+			temp0 = pp->logic3[0];
+			temp1 = pp->logic3[1];
+			pp->logic3[0] = temp0 & temp1;
+			pp->logic3[1] = temp0 | temp1;
 			//  Fix for scenario inp A and B = 'X';
-			temp0 = np->logic3[1];
-			np->logic3[2] = ((npIn_A->logic3[0]^npIn_A->logic3[1])&
-				(npIn_B->logic3[0]^npIn_B->logic3[1]))|temp0;
+			temp0 = pp->logic3[1];
+			pp->logic3[2] = ((ppIn_A->logic3[0]^ppIn_A->logic3[1])&
+				(ppIn_B->logic3[0]^ppIn_B->logic3[1]))|temp0;
 			break;
 		case AND:
 		case NAND:
 			if(N_inputs==1){
 				//  Special condition; must treat "AND" gate as a buffer with 1 input
 				for(k=0;k<3;k++){
-					np->logic3[k] = npIn_A->logic3[k];
+					pp->logic3[k] = ppIn_A->logic3[k];
 				}
 			}else{
 				for (inp = 1;inp<N_inputs;inp++){
-					npIn_B = getNodePtr(np->upNodes[inp]);
-					//npIn_B = &NodeV[ref2index[np->upNodes[inp]]];
+					ppIn_B = &ps[ref2index[np->upNodes[inp]]];
 					//  Bitwise &
 					for(k=0;k<3;k++){
-						np->logic3[k] = npIn_A->logic3[k] & npIn_B->logic3[k];
+						pp->logic3[k] = ppIn_A->logic3[k] & ppIn_B->logic3[k];
 					}
 					//  For more than 2 inputs, set first input equal to 
 					//  previous result.
-					npIn_A = np;
+					ppIn_A = pp;
 				}
 			}
 			break;
 		case OR:
 		case NOR:
 			for (inp = 1;inp<N_inputs;inp++){
-				npIn_B = getNodePtr(np->upNodes[inp]);
-				//npIn_B = &NodeV[ref2index[np->upNodes[inp]]];
+				ppIn_B = &ps[ref2index[np->upNodes[inp]]];
 				for(k=0;k<3;k++){
 					//  Bitwise OR
-					np->logic3[k] = npIn_A->logic3[k] | npIn_B->logic3[k];
+					pp->logic3[k] = ppIn_A->logic3[k] | ppIn_B->logic3[k];
 				}
 				//  For more than 2 inputs, set first input equal to 
 				//  previous result.
-				npIn_A = np;
+				ppIn_A = pp;
 			}
 			break;
 		case NOT:
 			//  Just copy over; inversion handled in next step
 			for(k=0;k<3;k++){
-				np->logic3[k] = npIn_A->logic3[k];
+				pp->logic3[k] = ppIn_A->logic3[k];
 			}
 			break;
 		default:
@@ -2402,39 +3083,20 @@ bool simNode3(int nodeRef){
 		(np->gateType==NOT))
 	{
 		//  Invert logic; C1 = NOT(A2), C2 = NOT(A1)
-		temp0 = np->logic3[0];
-		np->logic3[0] = ~np->logic3[1];
-		np->logic3[1] = ~temp0;
+		temp0 = pp->logic3[0];
+		pp->logic3[0] = ~pp->logic3[1];
+		pp->logic3[1] = ~temp0;
 	}
 	
 	//  Fault Application
 	for(k=0;k<2;k++){
-		np->logic3[k] = np->logic3[k] & np->fmask_AND;
-		np->logic3[k] = np->logic3[k] | np->fmask_OR;		
-	}
-	
-	//  Set single logic; needed for DFS
-	np->logic = np->logic3[0] & 1U;
-	
-	//////////////////////////debug //////////////////////
-	/*
-	char refStr[10];
-	printf("Processing Node:  %s, %d\n",gname(np->gateType), np->ref);
-	sprintf(refStr,"%d", np->ref);
-	printNode(refStr);
-	printf("\nInputs:");
-	printf("\n");
-	for(k=0;k<np->upNodes.size();k++){
-		sprintf(refStr,"%d", np->upNodes[k]);
-		printNode(refStr);
+		pp->logic3[k] = pp->logic3[k] & pp->fmask_AND;
+		pp->logic3[k] = pp->logic3[k] | pp->fmask_OR;		
 	}
-	printf("\n\n\n");
-	*/
-	//////////////////////////debug //////////////////////
 	
 	//  Function output to see if logic has changed
 	for(k=0;k<3;k++){
-		if(oldLogic[k] != np->logic3[k]){
+		if(!wordEqual(oldLogic[k], pp->logic3[k])){
 			return true;
 		}
 	}
@@ -2443,30 +3105,40 @@ bool simNode3(int nodeRef){
 	
 }
 
-void resetFaultMasks(void){
-	vector<NSTRUC>::iterator nodeIter;
-	for(nodeIter = NodeV.begin(); nodeIter!=NodeV.end();nodeIter++){
-		nodeIter->fmask_AND = ~0;//  Set to all 1's
-		nodeIter->fmask_OR = 0;
+template<typename W> void initParallelState(vector<PSTRUC<W> >& ps){
+	//  One entry per node, indexed like NodeV
+	//  Unknown state, 010, and no faults
+	PSTRUC<W> unknown;
+	wordZeros(unknown.logic3[0]);
+	wordOnes(unknown.logic3[1]);
+	wordZeros(unknown.logic3[2]);
+	wordOnes(unknown.fmask_AND);
+	wordZeros(unknown.fmask_OR);
+	ps.assign(NodeV.size(), unknown);
+}
+
+template<typename W> void resetFaultMasks(vector<PSTRUC<W> >& ps){
+	for(int i = 0;i<ps.size();i++){
+		wordOnes(ps[i].fmask_AND);//  Set to all 1's
+		wordZeros(ps[i].fmask_OR);
 	}
 }
-void addOutputPattern(int n_patterns){
+template<typename W> void addOutputPattern(vector<PSTRUC<W> >& ps, int n_patterns){
 	//  Write outputs to outputPatterns
 	//  For paralell processing, specify the # of patterns
 	vector<char> tempOutput;
 	
 	//  Cycle through each pattern.
-	for(int patt=n_patterns-1;patt>=0;patt--){
+	for(int patt=0;patt<n_patterns;patt++){
 		tempOutput.clear();
 		for(int k = 0;k<PO_Nodes.size();k++){
 			//  Use the "getLogic" to convert 5-value logic to a character
-			tempOutput.push_back(getLogic(PO_Nodes[k], patt));
+			tempOutput.push_back(getLogic(ps, PO_Nodes[k], patt));
 		}
 		outputPatterns.push_back(tempOutput);
 	}
 	
 }
-
 void reducedFL(void){
 	//  Generate the reduced fault list and populate the FaultV vector
 	std::vector<NSTRUC>::iterator np;
@@ -2557,10 +3229,6 @@ void _cread(char *cp)
 	vector<NSTRUC>::iterator nodeIter;
 
 	sscanf(cp, "%s", buf);
-	// Debug/////////////
-	printf("Read Circuit\n");
-	printf("File name: %s\n",buf);
-	//////////////////
 	
 	fd = fopen(buf,"r");
 	if(fd == NULL) {
@@ -2582,10 +3250,6 @@ void _cread(char *cp)
 		NSTRUC tempNode;
 		tempNode.ref = ref;
 		tempNode.level = -1;
-		//  Unknown state, 010
-		tempNode.logic3[0] = 0u;
-		tempNode.logic3[1] = ~0u;//  Set to all 1's
-		tempNode.logic3[2] = 0u;
 		tempNode.logic = false;
 		tempNode.logic5 = x;
 		tempNode.indx = index++;
@@ -2655,16 +3319,12 @@ void _cread(char *cp)
 		nodeIter->fout = nodeIter->downNodes.size();
 	}
 	
-	// Set all fault masks to known value
-	resetFaultMasks();
-	
 	//  Levelize Nodes
 	levelizeNodes();
    
 	//  Done; circuit is loaded
 	
 	printf("Parsed circuit %s\n", currentCircuit);
-	printf("==> OK\n");
 }
 
 
@@ -3127,7 +3787,11 @@ void writeAtpgReport(char *algType, double elapsedTime){
 	fprintf(fptr,"Algorithm: %s\n", algType);
 	fprintf(fptr,"Circuit: %s\n", currentCircuit);
 	fprintf(fptr,"Fault Coverage: %0.2f%%\n", 100*FC);
+	writeStats(fptr, stats_Dalg);
 	fprintf(fptr,"Time: %0.1f\n", elapsedTime);
+	if(learnTime_Dalg>=0){
+		fprintf(fptr,"Learning Time: %0.1f\n", learnTime_Dalg);
+	}
 	
 	printf("\n==> Writing ATPG report: %s\n",filename);
 	//  Done writing file
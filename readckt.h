@@ -4,6 +4,9 @@
 #include "includes.h"
 #include "structures.h"
 #include "defines.h"
+#include "Implications.h"
+#include "Dominators.h"
+#include "Compactor.h"
 //#include "Circuit.h"
 //#include "cktNode.h"
 
@@ -18,35 +21,56 @@ void genNodeIndex(void);
 int intCeil(int,int);
 
 //  Logic Simulation
-void processNodeQueue(void);
+template<typename W> void processNodeQueue(vector<PSTRUC<W> >&, vector< pair<int,int> >&);
 void simNode(int );
-void single_dfs(int );
-void dfs_logicSim(int patt);
-void dfs_logicSim(char *, int);
-void addPiNodesToQueue(void);
+void addPiNodesToQueue(vector< pair<int,int> >& queue);
 void addNodeToQueue(vector< pair<int,int> >& queue, int nodeRef);
 void logicInit(void);
-char getLogic(int , int);
-bool simNode3(int);
-void addOutputPattern(int);
-void checkFaults(int,int, int);
+template<typename W> char getLogic(vector<PSTRUC<W> >&, int , int);
+template<typename W> bool simNode3(vector<PSTRUC<W> >&, int);
+template<typename W> void addOutputPattern(vector<PSTRUC<W> >&, int);
+template<typename W> void checkFaults(vector<PSTRUC<W> >&, int,int, int);
 void genRandomInputs(int);
 void genAllFaults(void);
 float getFaultCoverage(void);
+int parallelWordBits(void);
 void parallelFaultSimulation(void);
 void parallelLogicSimulation(void);
+template<typename W> void parallelFaultSimulation(void);
+template<typename W> void pfsWorker(atomic<int> *nextPass);
+int pfsThreads(void);
+template<typename W> void parallelLogicSimulation(void);
+void concurrentFS(char *cp);
+void concurrentFaultSimulation(void);
+void cfsSchedule(int n);
+void cfsPropagate(void);
+void cfsEvalNode(int n, unsigned char &good, vector<CFREC> &list);
+unsigned char cfsGate(NSTRUC *np, unsigned char *vals);
 void dropFaults(void);
 void lSim(char *cp);
 
+//  Deductive Fault Simulation
+void dfsInit(void);
+void dfsPattern(int patt);
+void dfsClear(int n);
+void dfsTrim(int n);
+void dfsWiden(int n, int lo, int hi);
+void dfsUnion(int dst, int src);
+void dfsIntersect(int dst, int src);
+void dfsDifference(int dst, int src);
+void dfsXor(int dst, int src);
+void dfsAddFault(int n, int faultID);
+
 //   Display printouts
 void printInputPatterns(void);
 void printFaultList(void);
 
 //  Node Setup
-void setPI_forPLS(int, int);
-void setPI_forPFS(int);
-void setFaults(int, int);
-void resetFaultMasks(void);
+template<typename W> void setPI_forPLS(vector<PSTRUC<W> >&, int, int);
+template<typename W> void setPI_forPFS(vector<PSTRUC<W> >&, int);
+template<typename W> void setFaults(vector<PSTRUC<W> >&, int, int);
+template<typename W> void initParallelState(vector<PSTRUC<W> >&);
+template<typename W> void resetFaultMasks(vector<PSTRUC<W> >&);
 void reducedFL();
 
 //  File Read/Write
@@ -68,16 +92,26 @@ bool backward_logic(int nodeRef, bool &isJ, vector<int>& inputChangedList);
 enum e_logicType checkLogic_Dalg(int nodeRef, bool &isOK, bool &isJ, bool &isD);
 void branchPropogate_Dalg(int ref_B,enum e_logicType setLogic,  int origin);
 void printNode_Dalg(int nodeRef);
-void reloadState_Dalg(set<int>& J_front_save, set<int>& D_front_save, vector< pair<int,enum e_logicType> >& logicState);
+void reloadState_Dalg(int mark);
 int propogate_Jfrontier_Dalg(int nodeRef, int gateRef);
-void saveState_Dalg(set<int>& J_front_save, set<int>& D_front_save, vector< pair<int,enum e_logicType> >& logicState);
+int saveState_Dalg(void);
+void setLogic_Dalg(NSTRUC *np, enum e_logicType logic);
+void frontierInsert_Dalg(set<int>& frontier, int nodeRef);
+void frontierErase_Dalg(set<int>& frontier, int nodeRef);
 void propogate_Dfrontier_Dalg(int nodeRef, bool XOR_version);
 bool backwardsImply_Dalg(void);
 bool forwardImply_Dalg(void);
 void printFrontiers_Dalg(void);
 bool D_algorithm(void);
 int faultAtPO_Dalg(void);
+int goodValue_Dalg(enum e_logicType logic);
+bool learnedCheck_Dalg(int nodeRef);
+bool dominatorCheck_Dalg(void);
+bool sensitizeDominators_Dalg(int idx, bool assign);
+bool limitReached_Dalg(void);
 void addInputPattern_Dalg(void);
+void compactPatterns_Dalg(void);
+void setInputPatterns(inputList &);
 void writeAtpgReport(char *algType, double elapsedTime);
 void resetNodes_Dalg(void);
 void writeSingleReport_Dalg();
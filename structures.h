@@ -86,12 +86,62 @@ typedef struct n_struc {
    vector<int> downNodes;
    int level;                 /* level of the gate output */
    bool logic;
-   unsigned int logic3[3]; 	//  For PFS and PLS, 3-logic 0, 1, X
    enum e_logicType logic5; // 5-value logic Dalg and maybe PODEM
-   unsigned int fmask_AND; 	//  Fault Mask, AND
-   unsigned int fmask_OR;	//  Fault Mask, OR
 } NSTRUC;
 
+//  Word types for parallel logic/fault simulation (GCC vector extensions)
+typedef uint64_t word128_t __attribute__((vector_size(16)));
+typedef uint64_t word256_t __attribute__((vector_size(32)));
+
+//  Per-node state for PFS and PLS, one bit per pattern or per fault.
+//  Kept apart from NSTRUC so the word type can vary and each simulation
+//  can own its own copy.
+template<typename W> struct p_struc {
+   W logic3[3]; 	//  3-logic 0, 1, X
+   W fmask_AND; 	//  Fault Mask, AND
+   W fmask_OR;		//  Fault Mask, OR
+};
+template<typename W> using PSTRUC = p_struc<W>;
+
+//  Bit access that works for scalar and vector words alike
+template<typename W> inline int wordBits() {return 8*sizeof(W);}
+//  Fill through a reference: returning a 256-bit vector by value changes
+//  the ABI when AVX is not enabled
+template<typename W> inline void wordZeros(W &w) {memset(&w, 0, sizeof(W));}
+template<typename W> inline void wordOnes(W &w) {memset(&w, 0xff, sizeof(W));}
+template<typename W> inline bool wordGetBit(const W &w, int i) {
+	return (((const unsigned char *)&w)[i>>3] >> (i&7)) & 1;
+}
+template<typename W> inline void wordSetBit(W &w, int i) {
+	((unsigned char *)&w)[i>>3] |= (unsigned char)(1u<<(i&7));
+}
+template<typename W> inline void wordClearBit(W &w, int i) {
+	((unsigned char *)&w)[i>>3] &= (unsigned char)~(1u<<(i&7));
+}
+template<typename W> inline bool wordEqual(const W &a, const W &b) {
+	return memcmp(&a, &b, sizeof(W)) == 0;
+}
+
+//  xorshift64* generator; a word of 64 random bits per call, state != 0
+inline uint64_t randomWord(uint64_t &state) {
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dULL;
+}
+
+//  A word whose bits are 1 with probability k/16, 0 < k < 16. Bits of k
+//  from the lowest set one upward: a 1 ORs in a fresh random word, a 0
+//  ANDs one in, so each step halves the distance to 1 or to 0.
+inline uint64_t weightedWord(uint64_t &state, int k) {
+	int b = __builtin_ctz(k);
+	uint64_t w = randomWord(state);
+	for(++b;b<4;++b){
+		w = ((k>>b)&1) ? (w | randomWord(state)) : (w & randomWord(state));
+	}
+	return w;
+}
+
 
 typedef struct fault_struc{
 	int ref;  	// line number(May be different from indx 
@@ -99,6 +149,76 @@ typedef struct fault_struc{
 	vector<int> faultFound; // -1 = not found; else, is index of pattern
 } FSTRUC;
 
+//  D algorithm trail; one entry per change to a node value or to the
+//  D or J frontier, undone in reverse order on a backtrack
+enum e_trailType {
+	TRAIL_LOGIC = 0,	// node value changed; logic5 is the old value
+	TRAIL_D_ADD = 1,
+	TRAIL_D_ERASE = 2,
+	TRAIL_J_ADD = 3,
+	TRAIL_J_ERASE = 4,
+};
+typedef struct trail_struc{
+	enum e_trailType type;
+	int ref;	// line number of the node
+	enum e_logicType logic5;
+} TSTRUC;
+
+//  Concurrent fault simulation: one faulty machine at one node.
+//  Logic is the 2-rail value used by PFS, bit 0 = logic3[0] and
+//  bit 1 = logic3[1]: 0 = 00, 1 = 11, X = 10.
+#define CFS_ZERO	0x0
+#define CFS_ONE		0x3
+#define CFS_X		0x2
+typedef struct cf_rec{
+	int fault;		//  index into FaultV
+	unsigned char logic;
+} CFREC;
+
+//  ATPG outcome of a run.  Every targeted fault ends up detected,
+//  redundant (no test exists) or aborted (a backtrack or time limit
+//  was hit).  backtracks[] counts targeted faults by the number of
+//  backtracks spent on them: 0, 1, 2-3, 4-7, ...
+#define BT_BUCKETS 16
+typedef struct atpg_stats {
+	int total;			//  faults in the fault list
+	int detected;
+	int redundant;
+	int aborted;
+	int backtracks[BT_BUCKETS];
+} ATPGSTATS;
+
+inline void clearStats(ATPGSTATS &stats) {memset(&stats, 0, sizeof(ATPGSTATS));}
+inline void addBacktracks(ATPGSTATS &stats, int n) {
+	int b = 0;
+	while(n>0 && b<BT_BUCKETS-1){
+		n >>= 1;
+		b++;
+	}
+	stats.backtracks[b]++;
+}
+inline void writeStats(FILE *fptr, const ATPGSTATS &stats) {
+	double fe = stats.total>0 ? 100.0*(stats.detected+stats.redundant)/stats.total : 0;
+	fprintf(fptr,"Detected Faults: %d\n", stats.detected);
+	fprintf(fptr,"Redundant Faults: %d\n", stats.redundant);
+	fprintf(fptr,"Aborted Faults: %d\n", stats.aborted);
+	fprintf(fptr,"Fault Efficiency: %0.2f%%\n", fe);
+	fprintf(fptr,"Backtracks per targeted fault:\n");
+	int last = BT_BUCKETS-1;
+	while(last>0 && stats.backtracks[last]==0) last--;
+	for(int b=0;b<=last;++b){
+		int lo = b==0 ? 0 : 1<<(b-1);
+		int hi = b==0 ? 0 : (1<<b)-1;
+		if(b==BT_BUCKETS-1){
+			fprintf(fptr,"  %6d+      : %d\n", lo, stats.backtracks[b]);
+		}else if(lo==hi){
+			fprintf(fptr,"  %6d       : %d\n", lo, stats.backtracks[b]);
+		}else{
+			fprintf(fptr,"  %6d-%-6d: %d\n", lo, hi, stats.backtracks[b]);
+		}
+	}
+}
+
 const int bitWidth = 8*sizeof(int);
 
 #endif
\ No newline at end of file